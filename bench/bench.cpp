@@ -0,0 +1,384 @@
+// wave-bench: microbenchmark suite and regression harness.
+//
+// The only checked-in Wave program is example/example.wave, so every
+// workload here is synthesized from its shape: the same fun/print/count
+// mix, replicated with unique names until the unit is large enough to
+// time meaningfully. Four throughput metrics are tracked:
+//
+//   lex        lines/sec through the lexer
+//   parse      lines/sec through the parser
+//   sema       units/sec through name/type checking
+//   vm-calls   calls/sec through bytecode `fun` dispatch
+//   print-fmt  print formatting ops/sec in the VM (stdout -> /dev/null)
+//
+// The harness pins itself to one core, runs warmup iterations, then
+// reports the mean of N timed samples with a 95% confidence interval.
+// With --baseline it compares against a saved run and exits nonzero if
+// any metric regressed by more than kRegressionLimit, which is what CI
+// gates on; --save writes the current run as the new baseline.
+//
+// Usage: wave-bench [--samples N] [--warmup N]
+//                   [--baseline file] [--save file]
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sched.h>
+#include <unistd.h>
+
+#include "diag.h"
+#include "lexer.h"
+#include "parser.h"
+#include "sema.h"
+#include "bytecode.h"
+#include "vm.h"
+
+namespace wave {
+namespace {
+
+// A metric must fall more than this fraction below its baseline before
+// the harness fails the run.
+constexpr double kRegressionLimit = 0.03;
+
+using Clock = std::chrono::steady_clock;
+
+double now_seconds() {
+    return std::chrono::duration<double>(Clock::now().time_since_epoch())
+        .count();
+}
+
+// Pins the process to one core so samples are not spread across cores
+// with different frequency states. Best effort; failure is not fatal.
+void pin_to_core() {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(0, &set);
+    sched_setaffinity(0, sizeof(set), &set);
+}
+
+// --- workload synthesis, seeded from example/example.wave ----------------
+
+// Replicates the seed file's two-function shape `copies` times with
+// unique names so the parser and sema see one large well-formed unit.
+std::string make_compiler_input(int copies) {
+    std::string source;
+    for (int i = 0; i < copies; i++) {
+        std::string n = std::to_string(i);
+        source += "fun hello_" + n + "(name :str) {\n";
+        source += "    print(\"{}\", name);\n";
+        source += "}\n\n";
+        source += "fun run_" + n + "() {\n";
+        source += "    count a = 1;\n";
+        source += "    print(\"{a}\");\n";
+        source += "    hello_" + n + "(\"LunaStev\")\n";
+        source += "}\n\n";
+    }
+    return source;
+}
+
+// `calls` statement-level calls to an empty callee; lowered without
+// inlining this times pure frame setup and dispatch.
+std::string make_call_input(int calls) {
+    std::string source = "fun work() {\n}\n\nfun main() {\n";
+    for (int i = 0; i < calls; i++)
+        source += "    work();\n";
+    source += "}\n";
+    return source;
+}
+
+// `ops` integer prints through runtime-valued `var` locals, so the
+// constant folder cannot format them at compile time.
+std::string make_print_input(int ops) {
+    std::string source = "fun main() {\n";
+    for (int i = 0; i < ops; i++) {
+        std::string n = std::to_string(i);
+        source += "    var v" + n + " = " + std::to_string(i * 7 + 1) + ";\n";
+        source += "    print(\"{}\", v" + n + ");\n";
+    }
+    source += "}\n";
+    return source;
+}
+
+size_t count_lines(const std::string& source) {
+    size_t lines = 0;
+    for (char c : source)
+        if (c == '\n')
+            lines++;
+    return lines;
+}
+
+bool compile_source(const std::string& source, Module& module) {
+    module.file_name = module.arena.copy_string("<bench>");
+    try {
+        Lexer lexer("<bench>", source);
+        Parser parser("<bench>", lexer.lex_all(), module);
+        parser.parse_module();
+        analyze_module(module);
+    } catch (const CompileError&) {
+        return false;
+    }
+    return true;
+}
+
+// --- measurement ---------------------------------------------------------
+
+struct Result {
+    std::string name;
+    double mean = 0; // units/sec
+    double ci95 = 0; // half-width of the 95% confidence interval
+};
+
+// Runs `sample` (which processes `units` items and returns the seconds
+// its timed region took) `samples` times after `warmup` untimed calls
+// and reports throughput statistics. Samples time themselves so setup
+// work like re-parsing an AST stays out of the measurement.
+Result run_bench(const std::string& name, size_t units, int warmup,
+                 int samples, const std::function<double()>& sample) {
+    for (int i = 0; i < warmup; i++)
+        sample();
+
+    std::vector<double> rates;
+    for (int i = 0; i < samples; i++)
+        rates.push_back((double)units / sample());
+
+    double sum = 0;
+    for (double r : rates)
+        sum += r;
+    double mean = sum / (double)rates.size();
+    double var = 0;
+    for (double r : rates)
+        var += (r - mean) * (r - mean);
+    var /= (double)(rates.size() - 1);
+
+    Result result;
+    result.name = name;
+    result.mean = mean;
+    result.ci95 = 1.96 * std::sqrt(var / (double)rates.size());
+    return result;
+}
+
+// --- baselines -----------------------------------------------------------
+
+bool load_baseline(const std::string& path,
+                   std::map<std::string, double>& baseline) {
+    std::ifstream in(path);
+    if (!in)
+        return false;
+    std::string name;
+    double mean;
+    while (in >> name >> mean)
+        baseline[name] = mean;
+    return true;
+}
+
+bool save_baseline(const std::string& path,
+                   const std::vector<Result>& results) {
+    std::ofstream out(path, std::ios::trunc);
+    if (!out)
+        return false;
+    for (const Result& r : results)
+        out << r.name << " " << r.mean << "\n";
+    return true;
+}
+
+// Temporarily routes stdout to /dev/null so print benchmarks measure
+// formatting, not the terminal.
+class StdoutSilencer {
+public:
+    StdoutSilencer() {
+        std::fflush(stdout);
+        saved_ = dup(1);
+        int null_fd = ::open("/dev/null", O_WRONLY);
+        dup2(null_fd, 1);
+        ::close(null_fd);
+    }
+    ~StdoutSilencer() {
+        std::fflush(stdout);
+        dup2(saved_, 1);
+        ::close(saved_);
+    }
+
+private:
+    int saved_;
+};
+
+int bench_main(int argc, char** argv) {
+    int samples = 20;
+    int warmup = 3;
+    std::string baseline_path;
+    std::string save_path;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--samples" && i + 1 < argc)
+            samples = std::atoi(argv[++i]);
+        else if (arg == "--warmup" && i + 1 < argc)
+            warmup = std::atoi(argv[++i]);
+        else if (arg == "--baseline" && i + 1 < argc)
+            baseline_path = argv[++i];
+        else if (arg == "--save" && i + 1 < argc)
+            save_path = argv[++i];
+        else {
+            std::fprintf(stderr,
+                         "usage: wave-bench [--samples N] [--warmup N] "
+                         "[--baseline file] [--save file]\n");
+            return 2;
+        }
+    }
+    if (samples < 2) {
+        std::fprintf(stderr, "wave-bench: need at least 2 samples\n");
+        return 2;
+    }
+
+    pin_to_core();
+    std::vector<Result> results;
+
+    // Compiler throughput.
+    const std::string compiler_src = make_compiler_input(200);
+    const size_t lines = count_lines(compiler_src);
+
+    results.push_back(run_bench("lex", lines, warmup, samples, [&] {
+        double start = now_seconds();
+        Lexer lexer("<bench>", compiler_src);
+        lexer.lex_all();
+        return now_seconds() - start;
+    }));
+
+    results.push_back(run_bench("parse", lines, warmup, samples, [&] {
+        Lexer lexer("<bench>", compiler_src);
+        std::vector<Token> tokens = lexer.lex_all();
+        Module module;
+        double start = now_seconds();
+        Parser parser("<bench>", std::move(tokens), module);
+        parser.parse_module();
+        return now_seconds() - start;
+    }));
+
+    // Sema mutates the AST (print lowering), so each sample checks a
+    // batch of freshly parsed units; only analyze_module is timed.
+    constexpr int kSemaUnits = 32;
+    const std::string sema_src = make_compiler_input(8);
+    {
+        std::deque<Module> units;
+        results.push_back(run_bench("sema", kSemaUnits, warmup, samples, [&] {
+            units.clear();
+            for (int i = 0; i < kSemaUnits; i++) {
+                units.emplace_back();
+                Module& module = units.back();
+                module.file_name = module.arena.copy_string("<bench>");
+                Lexer lexer("<bench>", sema_src);
+                Parser parser("<bench>", lexer.lex_all(), module);
+                parser.parse_module();
+            }
+            double start = now_seconds();
+            for (Module& module : units)
+                analyze_module(module);
+            return now_seconds() - start;
+        }));
+    }
+
+    // Runtime throughput. Programs are lowered once; run_program is the
+    // timed region. Inlining is disabled for the call benchmark so the
+    // callee is not spliced away.
+    constexpr int kCallsPerRun = 256;
+    constexpr int kRunsPerSample = 200;
+    {
+        Module module;
+        if (!compile_source(make_call_input(kCallsPerRun), module))
+            return 1;
+        BcProgram program;
+        try {
+            program = lower_module(module, nullptr, /*instrumented=*/true);
+        } catch (const CompileError&) {
+            return 1;
+        }
+        results.push_back(run_bench("vm-calls",
+                                    (size_t)kCallsPerRun * kRunsPerSample,
+                                    warmup, samples, [&] {
+            double start = now_seconds();
+            for (int i = 0; i < kRunsPerSample; i++)
+                run_program(program);
+            return now_seconds() - start;
+        }));
+    }
+
+    constexpr int kPrintsPerRun = 100; // one local register per print
+    constexpr int kPrintRuns = 50;
+    {
+        Module module;
+        if (!compile_source(make_print_input(kPrintsPerRun), module))
+            return 1;
+        BcProgram program;
+        try {
+            program = lower_module(module);
+        } catch (const CompileError&) {
+            return 1;
+        }
+        StdoutSilencer silence;
+        results.push_back(run_bench("print-fmt",
+                                    (size_t)kPrintsPerRun * kPrintRuns,
+                                    warmup, samples, [&] {
+            double start = now_seconds();
+            for (int i = 0; i < kPrintRuns; i++)
+                run_program(program);
+            return now_seconds() - start;
+        }));
+    }
+
+    // Report, then gate.
+    std::map<std::string, double> baseline;
+    bool have_baseline = false;
+    if (!baseline_path.empty()) {
+        if (!load_baseline(baseline_path, baseline)) {
+            std::fprintf(stderr, "wave-bench: cannot read baseline '%s'\n",
+                         baseline_path.c_str());
+            return 1;
+        }
+        have_baseline = true;
+    }
+
+    bool regressed = false;
+    std::fprintf(stderr, "%-10s %14s %12s%s\n", "benchmark", "units/sec",
+                 "ci95", have_baseline ? "   vs baseline" : "");
+    for (const Result& r : results) {
+        std::fprintf(stderr, "%-10s %14.0f %11.0f", r.name.c_str(), r.mean,
+                     r.ci95);
+        if (have_baseline) {
+            auto it = baseline.find(r.name);
+            if (it == baseline.end()) {
+                std::fprintf(stderr, "       (new)");
+            } else {
+                double delta = r.mean / it->second - 1.0;
+                std::fprintf(stderr, "     %+7.2f%%", delta * 100);
+                if (delta < -kRegressionLimit) {
+                    std::fprintf(stderr, "  REGRESSION");
+                    regressed = true;
+                }
+            }
+        }
+        std::fprintf(stderr, "\n");
+    }
+
+    if (!save_path.empty() && !save_baseline(save_path, results)) {
+        std::fprintf(stderr, "wave-bench: cannot write '%s'\n",
+                     save_path.c_str());
+        return 1;
+    }
+    return regressed ? 1 : 0;
+}
+
+} // namespace
+} // namespace wave
+
+int main(int argc, char** argv) {
+    return wave::bench_main(argc, argv);
+}
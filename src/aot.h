@@ -0,0 +1,24 @@
+#pragma once
+
+#include <string>
+
+#include "ast.h"
+#include "profile.h"
+
+namespace wave {
+
+// Ahead-of-time backend: compiles an analyzed module to a relocatable
+// x86-64 ELF object. Each `fun` becomes a global symbol `wave_<name>`
+// with the System V C calling convention documented in
+// src/runtime/wave_rt.h — int parameters as int64 in one register,
+// string parameters as (pointer, length) in two — so the object links
+// straight into a C/C++ engine binary. String literals land in .rodata
+// and are referenced RIP-relative; I/O lowers to calls into libwave_rt.
+//
+// Runs the inlining pass first and applies the same constant/escape
+// folding as the bytecode tier. Throws CompileError on unsupported
+// shapes (more parameters than argument registers).
+std::string emit_object_x64(Module& module,
+                            const ProfileData* profile = nullptr);
+
+} // namespace wave
@@ -0,0 +1,795 @@
+#include "aot.h"
+
+#include <cstdio>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+#include <elf.h>
+
+#include "consteval.h"
+#include "diag.h"
+#include "escape.h"
+#include "inline.h"
+
+namespace wave {
+
+namespace {
+
+// System V integer argument registers, in order.
+enum Reg : uint8_t {
+    RAX = 0,
+    RCX = 1,
+    RDX = 2,
+    RSI = 6,
+    RDI = 7,
+    R8 = 8,
+    R9 = 9,
+};
+constexpr Reg kArgRegs[6] = {RDI, RSI, RDX, RCX, R8, R9};
+
+// A pending fixup in .text: either a PLT32 call to a named symbol or a
+// PC32 reference into .rodata.
+struct Reloc {
+    uint32_t text_off; // position of the 4-byte displacement field
+    bool is_call;
+    std::string symbol;  // call target (is_call)
+    uint32_t rodata_off; // literal offset (!is_call)
+};
+
+class ObjectWriter {
+public:
+    std::string text;
+    std::string rodata;
+    std::vector<Reloc> relocs;
+    std::vector<std::pair<std::string, uint32_t>> global_funs; // name, off
+
+    uint32_t add_literal(std::string_view bytes) {
+        // Literals are deduplicated; prints of the same segment share one
+        // .rodata entry.
+        auto it = literal_offsets_.find(std::string(bytes));
+        if (it != literal_offsets_.end())
+            return it->second;
+        uint32_t off = (uint32_t)rodata.size();
+        rodata.append(bytes.data(), bytes.size());
+        literal_offsets_.emplace(std::string(bytes), off);
+        return off;
+    }
+
+    // Numeric constants loaded by SSE instructions; padded to `align`
+    // (movaps faults on unaligned operands). Deduplicated separately so
+    // an aligned entry is never satisfied by an unaligned string byte.
+    uint32_t add_aligned(const void* data, size_t size, size_t align) {
+        std::string bytes((const char*)data, size);
+        auto it = aligned_offsets_.find(bytes);
+        if (it != aligned_offsets_.end())
+            return it->second;
+        while (rodata.size() % align)
+            rodata += '\0';
+        uint32_t off = (uint32_t)rodata.size();
+        rodata += bytes;
+        aligned_offsets_.emplace(std::move(bytes), off);
+        return off;
+    }
+
+    // -- instruction emission -------------------------------------------
+
+    void u8(uint8_t b) { text += (char)b; }
+    void u32(uint32_t v) { text.append((const char*)&v, 4); }
+    void u64(uint64_t v) { text.append((const char*)&v, 8); }
+
+    void rex_w(Reg reg, bool reg_in_modrm_reg) {
+        uint8_t rex = 0x48;
+        if (reg >= R8)
+            rex |= reg_in_modrm_reg ? 0x04 : 0x01;
+        u8(rex);
+    }
+
+    void modrm_rbp_disp(Reg reg, int32_t disp) {
+        u8(0x80 | ((reg & 7) << 3) | 5); // [rbp + disp32]
+        u32((uint32_t)disp);
+    }
+
+    void push_rbp() { u8(0x55); }
+    void mov_rbp_rsp() { u8(0x48); u8(0x89); u8(0xe5); }
+    void sub_rsp(uint32_t bytes) { u8(0x48); u8(0x81); u8(0xec); u32(bytes); }
+    void leave_ret() { u8(0xc9); u8(0xc3); }
+
+    void mov_store(int32_t rbp_disp, Reg src) {
+        rex_w(src, true);
+        u8(0x89);
+        modrm_rbp_disp(src, rbp_disp);
+    }
+
+    void mov_load(Reg dst, int32_t rbp_disp) {
+        rex_w(dst, true);
+        u8(0x8b);
+        modrm_rbp_disp(dst, rbp_disp);
+    }
+
+    void mov_imm(Reg dst, int64_t value) {
+        uint8_t rex = 0x48;
+        if (dst >= R8)
+            rex |= 0x01;
+        u8(rex);
+        u8(0xb8 + (dst & 7));
+        u64((uint64_t)value);
+    }
+
+    void lea_rodata(Reg dst, uint32_t rodata_off) {
+        rex_w(dst, true);
+        u8(0x8d);
+        u8(0x00 | ((dst & 7) << 3) | 5); // [rip + disp32]
+        relocs.push_back(Reloc{(uint32_t)text.size(), false, {}, rodata_off});
+        u32(0);
+    }
+
+    void call(const std::string& symbol) {
+        u8(0xe8);
+        relocs.push_back(Reloc{(uint32_t)text.size(), true, symbol, 0});
+        u32(0);
+    }
+
+    void lea_rbp(Reg dst, int32_t disp) {
+        rex_w(dst, true);
+        u8(0x8d);
+        modrm_rbp_disp(dst, disp);
+    }
+
+    // -- SSE (xmm0-xmm7, so no REX handling needed) ---------------------
+
+    void modrm_riprel(uint8_t xmm, uint32_t rodata_off) {
+        u8(0x00 | ((xmm & 7) << 3) | 5); // [rip + disp32]
+        relocs.push_back(Reloc{(uint32_t)text.size(), false, {}, rodata_off});
+        u32(0);
+    }
+
+    void movss_load(uint8_t xmm, int32_t disp) {
+        u8(0xf3); u8(0x0f); u8(0x10);
+        modrm_rbp_disp((Reg)xmm, disp);
+    }
+    void movss_store(int32_t disp, uint8_t xmm) {
+        u8(0xf3); u8(0x0f); u8(0x11);
+        modrm_rbp_disp((Reg)xmm, disp);
+    }
+    void movss_load_rodata(uint8_t xmm, uint32_t rodata_off) {
+        u8(0xf3); u8(0x0f); u8(0x10);
+        modrm_riprel(xmm, rodata_off);
+    }
+    void movaps_load(uint8_t xmm, int32_t disp) {
+        u8(0x0f); u8(0x28);
+        modrm_rbp_disp((Reg)xmm, disp);
+    }
+    void movaps_store(int32_t disp, uint8_t xmm) {
+        u8(0x0f); u8(0x29);
+        modrm_rbp_disp((Reg)xmm, disp);
+    }
+    void movaps_load_rodata(uint8_t xmm, uint32_t rodata_off) {
+        u8(0x0f); u8(0x28);
+        modrm_riprel(xmm, rodata_off);
+    }
+    // addps/mulps xmm, [rbp+disp] — one packed op per vector operation.
+    void ps_op_mem(uint8_t opcode, uint8_t xmm, int32_t disp) {
+        u8(0x0f); u8(opcode);
+        modrm_rbp_disp((Reg)xmm, disp);
+    }
+    void ps_op_rodata(uint8_t opcode, uint8_t xmm, uint32_t rodata_off) {
+        u8(0x0f); u8(opcode);
+        modrm_riprel(xmm, rodata_off);
+    }
+    void xorps_self(uint8_t xmm) {
+        u8(0x0f); u8(0x57); u8(0xc0 | ((xmm & 7) << 3) | (xmm & 7));
+    }
+    void cvtsi2ss_rax(uint8_t xmm) {
+        u8(0xf3); u8(0x48); u8(0x0f); u8(0x2a);
+        u8(0xc0 | ((xmm & 7) << 3)); // xmm, rax
+    }
+
+private:
+    std::unordered_map<std::string, uint32_t> literal_offsets_;
+    std::unordered_map<std::string, uint32_t> aligned_offsets_;
+};
+
+// addps/mulps opcode bytes (after the 0x0f escape).
+constexpr uint8_t kAddps = 0x58;
+constexpr uint8_t kMulps = 0x59;
+
+// Spill slots reserved in every frame for vector expression trees; one
+// live 16-byte temporary per nesting level.
+constexpr int kVecScratch = 4;
+
+// Compiles one function: named bindings live in negative rbp slots (ints
+// 8 bytes, strings 16 as pointer+length), statements emit in order, and
+// every expression materializes into argument registers right where a
+// call needs it.
+class FunctionCodegen {
+public:
+    FunctionCodegen(const Module& module, const FunDecl& fun,
+                    ObjectWriter& obj)
+        : module_(module), fun_(fun), obj_(obj) {}
+
+    void generate() {
+        escapes_ = analyze_escapes(fun_);
+        consts_ = analyze_consts(fun_);
+
+        obj_.global_funs.emplace_back(
+            "wave_" + std::string(sym_text(fun_.name)),
+            (uint32_t)obj_.text.size());
+
+        // First pass over declarations sizes the frame. Slots are
+        // conservative: 16 bytes covers any scalar or string half, and
+        // vectors may additionally pad to 16-byte alignment.
+        uint32_t frame = 16 * kVecScratch;
+        for (const Param& param : fun_.params)
+            frame += slot_size(param_type(param));
+        for (const Stmt* stmt : fun_.body)
+            if (stmt->kind == StmtKind::VarDecl)
+                frame += 32;
+        frame = (frame + 15) & ~15u;
+        next_disp_ = -16 * kVecScratch; // scratch sits just below rbp
+
+        obj_.push_rbp();
+        obj_.mov_rbp_rsp();
+        if (frame)
+            obj_.sub_rsp(frame);
+
+        // Spill incoming arguments to their slots.
+        uint32_t arg_reg = 0;
+        for (const Param& param : fun_.params) {
+            Type type = param_type(param);
+            if (type == Type::Float || vec_lanes(type))
+                fail("float and vector parameters are not yet supported "
+                     "by the AOT backend");
+            int32_t slot = alloc_slot(param.name, type);
+            if (arg_reg + (type == Type::Str ? 2 : 1) > 6)
+                fail("function has more parameters than argument registers");
+            obj_.mov_store(slot, kArgRegs[arg_reg++]);
+            if (type == Type::Str)
+                obj_.mov_store(slot + 8, kArgRegs[arg_reg++]);
+        }
+
+        for (const Stmt* stmt : fun_.body)
+            gen_stmt(*stmt);
+        obj_.leave_ret();
+    }
+
+private:
+    struct Slot {
+        int32_t disp;
+        Type type;
+    };
+
+    void gen_stmt(const Stmt& stmt) {
+        if (stmt.kind == StmtKind::Spawn)
+            fail("'spawn' is not yet supported by the AOT backend");
+        if (stmt.kind == StmtKind::VarDecl) {
+            const auto& decl = static_cast<const VarDeclStmt&>(stmt);
+            if (escapes_.static_strings.count(decl.name) ||
+                consts_.const_ints.count(decl.name))
+                return; // folded at use sites; no storage
+            Type type = expr_type(*decl.init);
+            int32_t slot = alloc_slot(decl.name, type);
+            if (type == Type::Float) {
+                load_f32(*decl.init, 0);
+                obj_.movss_store(slot, 0);
+                return;
+            }
+            if (vec_lanes(type)) {
+                load_vec(*decl.init, 0);
+                obj_.movaps_store(slot, 0);
+                return;
+            }
+            load_expr(*decl.init, RAX, RCX);
+            obj_.mov_store(slot, RAX);
+            if (type == Type::Str)
+                obj_.mov_store(slot + 8, RCX);
+            return;
+        }
+        const Expr* expr = static_cast<const ExprStmt&>(stmt).expr;
+        if (expr->kind == ExprKind::Print)
+            gen_print(static_cast<const PrintExpr&>(*expr));
+        else if (expr->kind == ExprKind::Call)
+            gen_call(static_cast<const CallExpr&>(*expr));
+    }
+
+    void gen_print(const PrintExpr& print) {
+        for (const PrintOp& op : print.ops) {
+            switch (op.kind) {
+            case PrintOpKind::WriteLit:
+                emit_write_lit(sym_text(op.literal));
+                break;
+            case PrintOpKind::WriteInt: {
+                int64_t value;
+                if (const_int(*op.arg, value)) {
+                    emit_write_lit(std::to_string(value));
+                    break;
+                }
+                load_expr(*op.arg, RDI, RSI);
+                obj_.call("wave_rt_write_int");
+                break;
+            }
+            case PrintOpKind::WriteFloat: {
+                if (op.arg->kind == ExprKind::FloatLit) {
+                    char buf[32];
+                    std::snprintf(buf, sizeof(buf), "%g",
+                                  (double)static_cast<const FloatLitExpr*>(
+                                      op.arg)->value);
+                    emit_write_lit(buf);
+                    break;
+                }
+                load_f32(*op.arg, 0); // float argument passes in xmm0
+                obj_.call("wave_rt_write_f32");
+                break;
+            }
+            case PrintOpKind::WriteVec: {
+                // wave_rt_write_vec takes (pointer, lanes); a named
+                // vector prints straight from its slot, anything else
+                // materializes into scratch first.
+                Type type = expr_type(*op.arg);
+                if (op.arg->kind == ExprKind::Ident) {
+                    obj_.lea_rbp(
+                        RDI,
+                        slots_.at(static_cast<const IdentExpr*>(op.arg)->name)
+                            .disp);
+                } else {
+                    load_vec(*op.arg, 0);
+                    obj_.movaps_store(scratch_disp(0), 0);
+                    obj_.lea_rbp(RDI, scratch_disp(0));
+                }
+                obj_.mov_imm(RSI, (int64_t)vec_lanes(type));
+                obj_.call("wave_rt_write_vec");
+                break;
+            }
+            case PrintOpKind::WriteStr: {
+                Symbol lit = static_string(*op.arg);
+                if (lit != kNoSymbol) {
+                    emit_write_lit(sym_text(lit));
+                    break;
+                }
+                load_expr(*op.arg, RDI, RSI);
+                obj_.call("wave_rt_write_str");
+                break;
+            }
+            }
+        }
+    }
+
+    void gen_call(const CallExpr& call) {
+        // A discarded vector builtin has no side effects; skip it.
+        if (vec_ctor_type(sym_text(call.callee)) != Type::Void ||
+            is_vec_binop(sym_text(call.callee)))
+            return;
+        // The sampler's shadow stack is an interpreter-tier structure;
+        // native code drops frame marks.
+        if (sym_text(call.callee) == "frame")
+            return;
+        const FunDecl* callee = nullptr;
+        for (const FunDecl* fun : module_.functions)
+            if (fun->name == call.callee)
+                callee = fun;
+        uint32_t arg_reg = 0;
+        for (uint32_t i = 0; i < call.args.size(); i++) {
+            Type type = expr_type(*call.args[i]);
+            if (type == Type::Float || vec_lanes(type))
+                fail("float and vector arguments are not yet supported "
+                     "by the AOT backend");
+            if (arg_reg + (type == Type::Str ? 2 : 1) > 6)
+                fail("call has more arguments than argument registers");
+            Reg lo = kArgRegs[arg_reg++];
+            Reg hi = type == Type::Str ? kArgRegs[arg_reg++] : RAX;
+            load_expr(*call.args[i], lo, hi);
+        }
+        (void)callee;
+        obj_.call("wave_" + std::string(sym_text(call.callee)));
+    }
+
+    void emit_write_lit(std::string_view bytes) {
+        obj_.lea_rodata(RDI, obj_.add_literal(bytes));
+        obj_.mov_imm(RSI, (int64_t)bytes.size());
+        obj_.call("wave_rt_write_lit");
+    }
+
+    // Materializes `expr` into `lo` (and `hi` for a string's length).
+    void load_expr(const Expr& expr, Reg lo, Reg hi) {
+        int64_t value;
+        Symbol lit = static_string(expr);
+        if (lit != kNoSymbol) {
+            std::string_view bytes = sym_text(lit);
+            obj_.lea_rodata(lo, obj_.add_literal(bytes));
+            obj_.mov_imm(hi, (int64_t)bytes.size());
+            return;
+        }
+        if (expr.kind == ExprKind::Call &&
+            sym_text(static_cast<const CallExpr&>(expr).callee) == "substr") {
+            load_substr(static_cast<const CallExpr&>(expr), lo, hi);
+            return;
+        }
+        if (const_int(expr, value)) {
+            obj_.mov_imm(lo, value);
+            return;
+        }
+        // A named binding with real storage.
+        const Slot& slot =
+            slots_.at(static_cast<const IdentExpr&>(expr).name);
+        obj_.mov_load(lo, slot.disp);
+        if (slot.type == Type::Str)
+            obj_.mov_load(hi, slot.disp + 8);
+    }
+
+    // A slice with a compile-time source and bounds is just a shorter
+    // literal; runtime slicing waits on a register allocator for the
+    // pointer arithmetic.
+    void load_substr(const CallExpr& call, Reg lo, Reg hi) {
+        Symbol src = static_string(*call.args[0]);
+        int64_t start, len;
+        if (src == kNoSymbol || !const_int(*call.args[1], start) ||
+            !const_int(*call.args[2], len))
+            fail("runtime 'substr' is not yet supported by the AOT "
+                 "backend");
+        std::string_view bytes = sym_text(src);
+        if (start < 0 || (uint64_t)start > bytes.size())
+            start = start < 0 ? 0 : (int64_t)bytes.size();
+        if (len < 0 || (uint64_t)len > bytes.size() - (uint64_t)start)
+            len = len < 0 ? 0 : (int64_t)(bytes.size() - (uint64_t)start);
+        std::string_view view = bytes.substr((size_t)start, (size_t)len);
+        obj_.lea_rodata(lo, obj_.add_literal(view));
+        obj_.mov_imm(hi, (int64_t)view.size());
+    }
+
+    Type expr_type(const Expr& expr) const {
+        switch (expr.kind) {
+        case ExprKind::IntLit:
+            return Type::Int;
+        case ExprKind::FloatLit:
+            return Type::Float;
+        case ExprKind::StrLit:
+            return Type::Str;
+        case ExprKind::Call: {
+            const auto& call = static_cast<const CallExpr&>(expr);
+            Type vec = vec_ctor_type(sym_text(call.callee));
+            if (vec != Type::Void)
+                return vec;
+            if (is_vec_binop(sym_text(call.callee)))
+                return expr_type(*call.args[0]);
+            if (sym_text(call.callee) == "substr")
+                return Type::Str;
+            return Type::Void;
+        }
+        case ExprKind::Ident: {
+            Symbol name = static_cast<const IdentExpr&>(expr).name;
+            if (escapes_.static_strings.count(name))
+                return Type::Str;
+            if (consts_.const_ints.count(name))
+                return Type::Int;
+            return slots_.at(name).type;
+        }
+        default:
+            return Type::Void;
+        }
+    }
+
+    Type param_type(const Param& param) const {
+        std::string_view text = sym_text(param.type_name);
+        if (text == "str" || text == "String")
+            return Type::Str;
+        if (text == "f32" || text == "float")
+            return Type::Float;
+        Type vec = vec_ctor_type(text);
+        if (vec != Type::Void)
+            return vec;
+        return Type::Int;
+    }
+
+    static uint32_t slot_size(Type type) {
+        return type == Type::Str || vec_lanes(type) ? 16 : 8;
+    }
+
+    int32_t alloc_slot(Symbol name, Type type) {
+        next_disp_ -= (int32_t)slot_size(type);
+        if (vec_lanes(type))
+            next_disp_ &= ~15; // movaps requires 16-byte alignment
+        slots_.emplace(name, Slot{next_disp_, type});
+        return next_disp_;
+    }
+
+    int32_t scratch_disp(int level) const { return -16 * (level + 1); }
+
+    // Materializes a float expression into xmm`xmm`.
+    void load_f32(const Expr& expr, uint8_t xmm) {
+        float value;
+        if (const_f32(expr, value)) {
+            obj_.movss_load_rodata(xmm, obj_.add_aligned(&value, 4, 4));
+            return;
+        }
+        const Slot& slot =
+            slots_.at(static_cast<const IdentExpr&>(expr).name);
+        if (slot.type == Type::Int) {
+            // Runtime integer component: widen through rax.
+            obj_.mov_load(RAX, slot.disp);
+            obj_.cvtsi2ss_rax(xmm);
+            return;
+        }
+        obj_.movss_load(xmm, slot.disp);
+    }
+
+    bool const_f32(const Expr& expr, float& value) const {
+        if (expr.kind == ExprKind::FloatLit) {
+            value = static_cast<const FloatLitExpr&>(expr).value;
+            return true;
+        }
+        int64_t int_value;
+        if (const_int(expr, int_value)) {
+            value = (float)int_value;
+            return true;
+        }
+        return false;
+    }
+
+    // True (filling `lanes`) if `expr` is a constructor whose components
+    // are all compile-time constants.
+    bool const_vec(const Expr& expr, float* lanes) const {
+        if (expr.kind != ExprKind::Call)
+            return false;
+        const auto& call = static_cast<const CallExpr&>(expr);
+        if (vec_ctor_type(sym_text(call.callee)) == Type::Void)
+            return false;
+        for (uint32_t i = 0; i < call.args.size(); i++)
+            if (!const_f32(*call.args[i], lanes[i]))
+                return false;
+        return true;
+    }
+
+    // Materializes a vector expression into xmm0. `depth` indexes the
+    // scratch slot a spilled operand may occupy; expression trees deeper
+    // than kVecScratch do not fit and are rejected.
+    void load_vec(const Expr& expr, int depth) {
+        if (depth >= kVecScratch)
+            fail("vector expression nests too deeply for the AOT backend");
+
+        float lanes[4] = {0, 0, 0, 0};
+        if (const_vec(expr, lanes)) {
+            obj_.movaps_load_rodata(0, obj_.add_aligned(lanes, 16, 16));
+            return;
+        }
+        if (expr.kind == ExprKind::Ident) {
+            obj_.movaps_load(
+                0, slots_.at(static_cast<const IdentExpr&>(expr).name).disp);
+            return;
+        }
+
+        const auto& call = static_cast<const CallExpr&>(expr);
+        if (vec_ctor_type(sym_text(call.callee)) != Type::Void) {
+            // Runtime components: fill the scratch slot lane by lane,
+            // zeroing the unused high lanes, then load it whole.
+            int32_t slot = scratch_disp(depth);
+            for (uint32_t l = 0; l < 4; l++) {
+                if (l < call.args.size())
+                    load_f32(*call.args[l], 0);
+                else
+                    obj_.xorps_self(0);
+                obj_.movss_store(slot + 4 * (int32_t)l, 0);
+            }
+            obj_.movaps_load(0, slot);
+            return;
+        }
+
+        // vadd/vmul: the packed op reads its second operand straight
+        // from memory — a named slot, a constant, or a spilled
+        // subexpression — so each operation is one instruction.
+        uint8_t opcode = sym_text(call.callee) == "vadd" ? kAddps : kMulps;
+        const Expr& lhs = *call.args[0];
+        const Expr& rhs = *call.args[1];
+        if (const_vec(rhs, lanes)) {
+            load_vec(lhs, depth);
+            obj_.ps_op_rodata(opcode, 0, obj_.add_aligned(lanes, 16, 16));
+        } else if (rhs.kind == ExprKind::Ident) {
+            load_vec(lhs, depth);
+            obj_.ps_op_mem(
+                opcode, 0,
+                slots_.at(static_cast<const IdentExpr&>(rhs).name).disp);
+        } else {
+            load_vec(rhs, depth);
+            obj_.movaps_store(scratch_disp(depth), 0);
+            load_vec(lhs, depth + 1);
+            obj_.ps_op_mem(opcode, 0, scratch_disp(depth));
+        }
+    }
+
+    Symbol static_string(const Expr& expr) const {
+        if (expr.kind == ExprKind::StrLit)
+            return static_cast<const StrLitExpr&>(expr).value;
+        if (expr.kind == ExprKind::Ident) {
+            auto it = escapes_.static_strings.find(
+                static_cast<const IdentExpr&>(expr).name);
+            if (it != escapes_.static_strings.end())
+                return it->second;
+        }
+        return kNoSymbol;
+    }
+
+    bool const_int(const Expr& expr, int64_t& value) const {
+        if (expr.kind == ExprKind::IntLit) {
+            value = static_cast<const IntLitExpr&>(expr).value;
+            return true;
+        }
+        if (expr.kind == ExprKind::Ident) {
+            auto it = consts_.const_ints.find(
+                static_cast<const IdentExpr&>(expr).name);
+            if (it != consts_.const_ints.end()) {
+                value = it->second;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    [[noreturn]] void fail(const std::string& msg) const {
+        error(module_.file_name, fun_.line, fun_.col, msg);
+        throw CompileError();
+    }
+
+    const Module& module_;
+    const FunDecl& fun_;
+    ObjectWriter& obj_;
+    EscapeInfo escapes_;
+    ConstInfo consts_;
+    std::unordered_map<Symbol, Slot> slots_;
+    int32_t next_disp_ = 0;
+};
+
+// Packs text/rodata/relocations into an ELF64 relocatable file.
+std::string write_elf(ObjectWriter& obj) {
+    // Section order: null, .text, .rela.text, .rodata, .symtab, .strtab,
+    // .shstrtab.
+    enum { SEC_TEXT = 1, SEC_RELA, SEC_RODATA, SEC_SYMTAB, SEC_STRTAB,
+           SEC_SHSTRTAB, SEC_NOTE_STACK, SEC_COUNT };
+
+    std::string strtab;
+    strtab += '\0';
+    auto add_name = [&](const std::string& name) {
+        uint32_t off = (uint32_t)strtab.size();
+        strtab += name;
+        strtab += '\0';
+        return off;
+    };
+
+    // Symbols: null, .rodata section symbol (locals), then globals:
+    // defined functions followed by undefined runtime helpers.
+    std::vector<Elf64_Sym> syms(2);
+    std::memset(syms.data(), 0, sizeof(Elf64_Sym) * syms.size());
+    syms[1].st_info = ELF64_ST_INFO(STB_LOCAL, STT_SECTION);
+    syms[1].st_shndx = SEC_RODATA;
+    uint32_t first_global = 2;
+
+    std::unordered_map<std::string, uint32_t> sym_index;
+    for (const auto& [name, off] : obj.global_funs) {
+        Elf64_Sym sym;
+        std::memset(&sym, 0, sizeof(sym));
+        sym.st_name = add_name(name);
+        sym.st_info = ELF64_ST_INFO(STB_GLOBAL, STT_FUNC);
+        sym.st_shndx = SEC_TEXT;
+        sym.st_value = off;
+        sym_index.emplace(name, (uint32_t)syms.size());
+        syms.push_back(sym);
+    }
+    for (const Reloc& reloc : obj.relocs) {
+        if (!reloc.is_call || sym_index.count(reloc.symbol))
+            continue;
+        Elf64_Sym sym;
+        std::memset(&sym, 0, sizeof(sym));
+        sym.st_name = add_name(reloc.symbol);
+        sym.st_info = ELF64_ST_INFO(STB_GLOBAL, STT_NOTYPE);
+        sym.st_shndx = SHN_UNDEF;
+        sym_index.emplace(reloc.symbol, (uint32_t)syms.size());
+        syms.push_back(sym);
+    }
+
+    std::vector<Elf64_Rela> relas;
+    for (const Reloc& reloc : obj.relocs) {
+        Elf64_Rela rela;
+        rela.r_offset = reloc.text_off;
+        if (reloc.is_call) {
+            rela.r_info =
+                ELF64_R_INFO(sym_index.at(reloc.symbol), R_X86_64_PLT32);
+            rela.r_addend = -4;
+        } else {
+            rela.r_info = ELF64_R_INFO(1, R_X86_64_PC32); // .rodata
+            rela.r_addend = (int64_t)reloc.rodata_off - 4;
+        }
+        relas.push_back(rela);
+    }
+
+    std::string shstrtab;
+    shstrtab += '\0';
+    auto add_sec_name = [&](const char* name) {
+        uint32_t off = (uint32_t)shstrtab.size();
+        shstrtab += name;
+        shstrtab += '\0';
+        return off;
+    };
+    uint32_t n_text = add_sec_name(".text");
+    uint32_t n_rela = add_sec_name(".rela.text");
+    uint32_t n_rodata = add_sec_name(".rodata");
+    uint32_t n_symtab = add_sec_name(".symtab");
+    uint32_t n_strtab = add_sec_name(".strtab");
+    uint32_t n_shstrtab = add_sec_name(".shstrtab");
+    uint32_t n_note_stack = add_sec_name(".note.GNU-stack");
+
+    // Lay the file out: header, section bodies, then section headers.
+    uint64_t off = sizeof(Elf64_Ehdr);
+    auto place = [&](size_t size, uint64_t align) {
+        off = (off + align - 1) & ~(align - 1);
+        uint64_t at = off;
+        off += size;
+        return at;
+    };
+    uint64_t text_off = place(obj.text.size(), 16);
+    uint64_t rela_off = place(relas.size() * sizeof(Elf64_Rela), 8);
+    uint64_t rodata_off = place(obj.rodata.size(), 16);
+    uint64_t symtab_off = place(syms.size() * sizeof(Elf64_Sym), 8);
+    uint64_t strtab_off = place(strtab.size(), 1);
+    uint64_t shstrtab_off = place(shstrtab.size(), 1);
+    uint64_t shdr_off = place(SEC_COUNT * sizeof(Elf64_Shdr), 8);
+
+    Elf64_Ehdr ehdr;
+    std::memset(&ehdr, 0, sizeof(ehdr));
+    std::memcpy(ehdr.e_ident, ELFMAG, SELFMAG);
+    ehdr.e_ident[EI_CLASS] = ELFCLASS64;
+    ehdr.e_ident[EI_DATA] = ELFDATA2LSB;
+    ehdr.e_ident[EI_VERSION] = EV_CURRENT;
+    ehdr.e_type = ET_REL;
+    ehdr.e_machine = EM_X86_64;
+    ehdr.e_version = EV_CURRENT;
+    ehdr.e_shoff = shdr_off;
+    ehdr.e_ehsize = sizeof(Elf64_Ehdr);
+    ehdr.e_shentsize = sizeof(Elf64_Shdr);
+    ehdr.e_shnum = SEC_COUNT;
+    ehdr.e_shstrndx = SEC_SHSTRTAB;
+
+    Elf64_Shdr shdrs[SEC_COUNT];
+    std::memset(shdrs, 0, sizeof(shdrs));
+    shdrs[SEC_TEXT] = {n_text, SHT_PROGBITS, SHF_ALLOC | SHF_EXECINSTR, 0,
+                       text_off, obj.text.size(), 0, 0, 16, 0};
+    shdrs[SEC_RELA] = {n_rela, SHT_RELA, SHF_INFO_LINK, 0, rela_off,
+                       relas.size() * sizeof(Elf64_Rela), SEC_SYMTAB,
+                       SEC_TEXT, 8, sizeof(Elf64_Rela)};
+    shdrs[SEC_RODATA] = {n_rodata, SHT_PROGBITS, SHF_ALLOC, 0, rodata_off,
+                         obj.rodata.size(), 0, 0, 16, 0};
+    shdrs[SEC_SYMTAB] = {n_symtab, SHT_SYMTAB, 0, 0, symtab_off,
+                         syms.size() * sizeof(Elf64_Sym), SEC_STRTAB,
+                         first_global, 8, sizeof(Elf64_Sym)};
+    shdrs[SEC_STRTAB] = {n_strtab, SHT_STRTAB, 0, 0, strtab_off,
+                         strtab.size(), 0, 0, 1, 0};
+    shdrs[SEC_SHSTRTAB] = {n_shstrtab, SHT_STRTAB, 0, 0, shstrtab_off,
+                           shstrtab.size(), 0, 0, 1, 0};
+    // Empty marker so linkers know the object needs no executable stack.
+    shdrs[SEC_NOTE_STACK] = {n_note_stack, SHT_PROGBITS, 0, 0, shstrtab_off,
+                             0, 0, 0, 1, 0};
+
+    std::string out(off, '\0');
+    auto copy = [&](uint64_t at, const void* data, size_t size) {
+        std::memcpy(&out[at], data, size);
+    };
+    copy(0, &ehdr, sizeof(ehdr));
+    copy(text_off, obj.text.data(), obj.text.size());
+    copy(rela_off, relas.data(), relas.size() * sizeof(Elf64_Rela));
+    copy(rodata_off, obj.rodata.data(), obj.rodata.size());
+    copy(symtab_off, syms.data(), syms.size() * sizeof(Elf64_Sym));
+    copy(strtab_off, strtab.data(), strtab.size());
+    copy(shstrtab_off, shstrtab.data(), shstrtab.size());
+    copy(shdr_off, shdrs, sizeof(shdrs));
+    return out;
+}
+
+} // namespace
+
+std::string emit_object_x64(Module& module, const ProfileData* profile) {
+    inline_calls(module, profile);
+
+    ObjectWriter obj;
+    for (const FunDecl* fun : module.functions)
+        FunctionCodegen(module, *fun, obj).generate();
+    return write_elf(obj);
+}
+
+} // namespace wave
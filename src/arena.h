@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace wave {
+
+// A read-only view into arena-owned storage. AST nodes use spans instead of
+// std::vector so that releasing the arena releases everything; nothing in
+// the tree owns heap memory of its own.
+template <class T>
+struct Span {
+    T* data = nullptr;
+    uint32_t len = 0;
+
+    T* begin() const { return data; }
+    T* end() const { return data + len; }
+    T& operator[](uint32_t i) const { return data[i]; }
+    uint32_t size() const { return len; }
+    bool empty() const { return len == 0; }
+};
+
+// Bump allocator with chunked backing storage. Allocation is a pointer
+// increment; there is no per-object free — the whole arena is released at
+// once when the owning compilation unit is destroyed. Only trivially
+// destructible types may live here, which is what makes bulk release O(1).
+class Arena {
+public:
+    static constexpr size_t kDefaultChunkSize = 64 * 1024;
+
+    Arena() = default;
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    ~Arena() {
+        for (Chunk& chunk : chunks_)
+            std::free(chunk.base);
+    }
+
+    template <class T, class... Args>
+    T* alloc(Args&&... args) {
+        static_assert(std::is_trivially_destructible_v<T>,
+                      "arena objects are bulk-freed without running dtors");
+        void* mem = alloc_raw(sizeof(T), alignof(T));
+        return new (mem) T(static_cast<Args&&>(args)...);
+    }
+
+    // Copies the bytes of `text` into the arena and returns a view of the
+    // copy, so token/AST strings survive their source buffer.
+    std::string_view copy_string(std::string_view text) {
+        if (text.empty())
+            return {};
+        char* mem = static_cast<char*>(alloc_raw(text.size(), 1));
+        std::memcpy(mem, text.data(), text.size());
+        return {mem, text.size()};
+    }
+
+    template <class T>
+    Span<T> copy_span(const std::vector<T>& items) {
+        static_assert(std::is_trivially_destructible_v<T>,
+                      "arena objects are bulk-freed without running dtors");
+        Span<T> span;
+        span.len = (uint32_t)items.size();
+        if (span.len == 0)
+            return span;
+        span.data = static_cast<T*>(
+            alloc_raw(sizeof(T) * items.size(), alignof(T)));
+        for (uint32_t i = 0; i < span.len; i++)
+            new (span.data + i) T(items[i]);
+        return span;
+    }
+
+    // High-water mark of live bytes requested from this arena; use it to
+    // size the initial chunk for a given workload.
+    size_t bytes_used() const { return bytes_used_; }
+    size_t bytes_reserved() const { return bytes_reserved_; }
+    size_t chunk_count() const { return chunks_.size(); }
+
+private:
+    struct Chunk {
+        char* base = nullptr;
+        size_t size = 0;
+    };
+
+    void* alloc_raw(size_t size, size_t align) {
+        size_t aligned = (cursor_ + align - 1) & ~(align - 1);
+        if (chunks_.empty() || aligned + size > chunks_.back().size) {
+            grow(size + align);
+            aligned = (cursor_ + align - 1) & ~(align - 1);
+        }
+        void* mem = chunks_.back().base + aligned;
+        bytes_used_ += (aligned - cursor_) + size;
+        cursor_ = aligned + size;
+        return mem;
+    }
+
+    void grow(size_t min_size) {
+        size_t size = chunks_.empty() ? kDefaultChunkSize
+                                      : chunks_.back().size * 2;
+        while (size < min_size)
+            size *= 2;
+        Chunk chunk;
+        chunk.base = static_cast<char*>(std::malloc(size));
+        chunk.size = size;
+        chunks_.push_back(chunk);
+        bytes_reserved_ += size;
+        cursor_ = 0;
+    }
+
+    std::vector<Chunk> chunks_;
+    size_t cursor_ = 0;
+    size_t bytes_used_ = 0;
+    size_t bytes_reserved_ = 0;
+};
+
+} // namespace wave
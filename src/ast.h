@@ -0,0 +1,230 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+#include "arena.h"
+#include "interner.h"
+
+namespace wave {
+
+// Compact AST emitted directly by the recursive-descent parser: no
+// per-token parse-tree layer, one node per semantic construct. Nodes are
+// plain structs discriminated by a kind tag and live in the owning
+// Module's arena, so a finished compilation unit is released in O(1).
+// Identifiers and string literals are interned Symbols; child lists are
+// views into arena storage.
+
+struct Node {
+    uint32_t line = 0;
+    uint32_t col = 0;
+};
+
+enum class ExprKind : uint8_t {
+    IntLit,
+    FloatLit,
+    StrLit,
+    Ident,
+    Call,
+    Field,    // struct field access; rewritten away before lowering
+    ArrayLit, // [e0, e1, ...]; rewritten away before type checking
+    Print,    // lowered `print` call; only exists after sema
+};
+
+struct Expr : Node {
+    ExprKind kind;
+    explicit Expr(ExprKind k) : kind(k) {}
+};
+
+struct IntLitExpr : Expr {
+    int64_t value = 0;
+    IntLitExpr() : Expr(ExprKind::IntLit) {}
+};
+
+struct FloatLitExpr : Expr {
+    float value = 0;
+    FloatLitExpr() : Expr(ExprKind::FloatLit) {}
+};
+
+struct StrLitExpr : Expr {
+    Symbol value = kNoSymbol;
+    StrLitExpr() : Expr(ExprKind::StrLit) {}
+};
+
+struct IdentExpr : Expr {
+    Symbol name = kNoSymbol;
+    IdentExpr() : Expr(ExprKind::Ident) {}
+};
+
+struct CallExpr : Expr {
+    Symbol callee = kNoSymbol;
+    Span<Expr*> args;
+    CallExpr() : Expr(ExprKind::Call) {}
+};
+
+struct FieldExpr : Expr {
+    Expr* base = nullptr;
+    Symbol field = kNoSymbol;
+    FieldExpr() : Expr(ExprKind::Field) {}
+};
+
+// A fixed, compile-time-sized sequence of homogeneous values. Arrays
+// are value types like structs: the batch pass (batch.h) splices them
+// into one binding per element, so they occupy no header and never
+// allocate.
+struct ArrayLitExpr : Expr {
+    Span<Expr*> elems;
+    ArrayLitExpr() : Expr(ExprKind::ArrayLit) {}
+};
+
+// The minimal type lattice the checker needs today. The vector types
+// are fixed-width f32 lanes with a guaranteed 16-byte-aligned layout so
+// arithmetic on them lowers to SSE instructions, never per-lane loops;
+// vec2f/vec3f occupy a full 16-byte slot with the high lanes zero.
+enum class Type : uint8_t {
+    Int,
+    Float,
+    Str,
+    Vec2,
+    Vec3,
+    Vec4,
+    Void,
+};
+
+// Lane count for the vector types, 0 otherwise.
+inline uint32_t vec_lanes(Type type) {
+    switch (type) {
+    case Type::Vec2: return 2;
+    case Type::Vec3: return 3;
+    case Type::Vec4: return 4;
+    default:         return 0;
+    }
+}
+
+// Vector constructors and arithmetic are builtin calls, not user
+// functions; every tier (sema, bytecode, AOT) classifies them with
+// these helpers so the name set lives in one place.
+inline Type vec_ctor_type(std::string_view callee) {
+    if (callee == "vec2f") return Type::Vec2;
+    if (callee == "vec3f") return Type::Vec3;
+    if (callee == "vec4f") return Type::Vec4;
+    return Type::Void;
+}
+
+inline bool is_vec_binop(std::string_view callee) {
+    return callee == "vadd" || callee == "vmul";
+}
+
+// One lowered `print` operation. Format strings are parsed at compile
+// time; at runtime a print is a straight sequence of typed writes with no
+// brace scanning and no intermediate string.
+enum class PrintOpKind : uint8_t {
+    WriteLit,   // emit an interned literal segment
+    WriteInt,   // emit the integer value of `arg`
+    WriteFloat, // emit the float value of `arg`
+    WriteStr,   // emit the string value of `arg`
+    WriteVec,   // emit the vector value of `arg` as "(x, y, ...)"
+};
+
+struct PrintOp {
+    PrintOpKind kind;
+    Symbol literal = kNoSymbol; // WriteLit only
+    Expr* arg = nullptr;        // WriteInt / WriteStr only
+};
+
+struct PrintExpr : Expr {
+    Span<PrintOp> ops;
+    PrintExpr() : Expr(ExprKind::Print) {}
+};
+
+enum class StmtKind : uint8_t {
+    VarDecl,   // both `var` and `count` bindings
+    Expr,
+    Spawn,     // `spawn f(args)`: run the call as a parallel task
+    Each,      // `each x in xs { ... }`: batch iteration over an array
+};
+
+struct Stmt : Node {
+    StmtKind kind;
+    explicit Stmt(StmtKind k) : kind(k) {}
+};
+
+struct VarDeclStmt : Stmt {
+    bool is_count = false;      // `count` bindings are immutable
+    bool is_soa = false;        // `@soa` array: field-major layout
+    Symbol name = kNoSymbol;
+    Symbol type_name = kNoSymbol; // kNoSymbol when the type is inferred
+    Expr* init = nullptr;
+    VarDeclStmt() : Stmt(StmtKind::VarDecl) {}
+};
+
+struct ExprStmt : Stmt {
+    Expr* expr = nullptr;
+    ExprStmt() : Stmt(StmtKind::Expr) {}
+};
+
+// Structured: every task spawned in a function joins implicitly before
+// the function returns.
+struct SpawnStmt : Stmt {
+    CallExpr* call = nullptr;
+    SpawnStmt() : Stmt(StmtKind::Spawn) {}
+};
+
+// Batch iteration. The element count is known at compile time, so the
+// loop is guaranteed to lower to a single linear sweep over the
+// elements' bindings: fully unrolled, no bounds checks, no iterator
+// object, and vector-typed fields keep their packed SSE lowering.
+struct EachStmt : Stmt {
+    Symbol var = kNoSymbol;
+    Expr* seq = nullptr;
+    Span<Stmt*> body;
+    EachStmt() : Stmt(StmtKind::Each) {}
+};
+
+struct Param {
+    Symbol name = kNoSymbol;
+    Symbol type_name = kNoSymbol;
+};
+
+struct FunDecl : Node {
+    // `async fun`s run off the calling thread: they can only be
+    // entered with `spawn`, never called synchronously, which is what
+    // lets the scheduler treat them as bounded tasks today and gives
+    // `await` suspension points a place to land later.
+    bool is_async = false;
+    Symbol name = kNoSymbol;
+    // Generic type parameters (`fun lerp[T](...)`). Non-empty marks a
+    // template, expanded away by monomorphization (generics.h) during
+    // checking; lowering never sees an open type parameter.
+    Span<Symbol> type_params;
+    Span<Param> params;
+    Span<Stmt*> body;
+};
+
+// A value type: fields stored inline in declaration order with no
+// per-object header. Struct values are flattened to their scalar fields
+// at compile time (see structs.h), so they never box or allocate.
+struct StructDecl : Node {
+    Symbol name = kNoSymbol;
+    Span<Param> fields; // field name + type name, like params
+};
+
+struct Module {
+    std::string_view file_name; // arena-owned
+    Span<FunDecl*> functions;
+    Span<StructDecl*> structs;
+    Arena arena;
+
+    template <class T>
+    T* make(uint32_t line, uint32_t col) {
+        T* node = arena.alloc<T>();
+        node->line = line;
+        node->col = col;
+        return node;
+    }
+};
+
+// Debug pretty-printer used by `wave parse`.
+void dump_module(const Module& module);
+
+} // namespace wave
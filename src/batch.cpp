@@ -0,0 +1,401 @@
+#include "batch.h"
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "diag.h"
+
+namespace wave {
+
+namespace {
+
+class BatchExpander {
+public:
+    explicit BatchExpander(Module& module) : module_(module) {}
+
+    void run() {
+        for (FunDecl* fun : module_.functions)
+            expand_function(*fun);
+    }
+
+private:
+    void expand_function(FunDecl& fun) {
+        arrays_.clear();
+        std::vector<Stmt*> body;
+        for (Stmt* stmt : fun.body)
+            expand_stmt(stmt, body);
+        fun.body = module_.arena.copy_span(body);
+    }
+
+    void expand_stmt(Stmt* stmt, std::vector<Stmt*>& body) {
+        if (stmt->kind == StmtKind::Each) {
+            expand_each(*static_cast<EachStmt*>(stmt), body);
+            return;
+        }
+        if (stmt->kind == StmtKind::VarDecl) {
+            auto* decl = static_cast<VarDeclStmt*>(stmt);
+            if (decl->is_soa && decl->init->kind != ExprKind::ArrayLit &&
+                !(decl->init->kind == ExprKind::Ident &&
+                  arrays_.count(static_cast<IdentExpr*>(decl->init)->name)))
+                fail(*decl, "'@soa' applies to array bindings");
+            if (decl->init->kind == ExprKind::ArrayLit) {
+                bind_elems(*decl, sym_text(decl->name),
+                           static_cast<ArrayLitExpr*>(decl->init)->elems,
+                           body);
+                return;
+            }
+            if (decl->init->kind == ExprKind::Ident) {
+                auto it = arrays_.find(
+                    static_cast<IdentExpr*>(decl->init)->name);
+                if (it != arrays_.end()) {
+                    bind_moves(*decl, sym_text(decl->name),
+                               sym_text(it->first), it->second, body);
+                    return;
+                }
+            }
+        }
+        check_no_arrays(*stmt);
+        body.push_back(stmt);
+    }
+
+    // var ps = [a, b, c]: one binding per element, named "ps.<i>". The
+    // struct pass runs next and decomposes struct-typed elements
+    // further, so an array of structs ends up as per-field scalars in
+    // element order — the SoA-friendly layout, by construction.
+    void bind_elems(const VarDeclStmt& at, std::string_view name,
+                    Span<Expr*> elems, std::vector<Stmt*>& body) {
+        if (elems.size() == 0)
+            fail(at, "array literal needs at least one element");
+        for (uint32_t i = 0; i < elems.size(); i++) {
+            VarDeclStmt* elem = module_.make<VarDeclStmt>(at.line, at.col);
+            elem->is_count = at.is_count;
+            elem->is_soa = at.is_soa;
+            elem->name = elem_name(name, i);
+            elem->type_name = at.type_name;
+            elem->init = elems[i];
+            body.push_back(elem);
+        }
+        arrays_.emplace(intern(name), elems.size());
+    }
+
+    // var qs = ps: per-element moves from the source's bindings.
+    void bind_moves(const VarDeclStmt& at, std::string_view dst,
+                    std::string_view src, uint32_t count,
+                    std::vector<Stmt*>& body) {
+        for (uint32_t i = 0; i < count; i++) {
+            VarDeclStmt* elem = module_.make<VarDeclStmt>(at.line, at.col);
+            elem->is_count = at.is_count;
+            elem->is_soa = at.is_soa;
+            elem->name = elem_name(dst, i);
+            elem->type_name = at.type_name;
+            IdentExpr* from = module_.make<IdentExpr>(at.line, at.col);
+            from->name = elem_name(src, i);
+            elem->init = from;
+            body.push_back(elem);
+        }
+        arrays_.emplace(intern(dst), count);
+    }
+
+    // each x in xs { ... }: the body is spliced once per element with
+    // `x` bound to the element's bindings. Body-local names get a fresh
+    // suffix per iteration so repeated declarations stay distinct.
+    void expand_each(const EachStmt& each, std::vector<Stmt*>& body) {
+        std::string_view seq;
+        uint32_t count = 0;
+        if (each.seq->kind == ExprKind::ArrayLit) {
+            // An inline literal is first materialized like a binding.
+            VarDeclStmt tmp;
+            tmp.line = each.line;
+            tmp.col = each.col;
+            std::string name = "each$" + std::to_string(next_id_++);
+            bind_elems(tmp, name,
+                       static_cast<ArrayLitExpr*>(each.seq)->elems, body);
+            seq = sym_text(intern(name));
+            count = arrays_.at(intern(name));
+        } else if (each.seq->kind == ExprKind::Ident) {
+            auto it =
+                arrays_.find(static_cast<IdentExpr*>(each.seq)->name);
+            if (it == arrays_.end())
+                fail(each, "'each' expects an array");
+            seq = sym_text(it->first);
+            count = it->second;
+        } else {
+            fail(each, "'each' expects an array");
+        }
+
+        for (uint32_t i = 0; i < count; i++) {
+            Cloner cloner(module_, each.var, elem_name(seq, i), next_id_++);
+            for (const Stmt* stmt : each.body)
+                expand_stmt(cloner.clone(stmt), body);
+        }
+    }
+
+    // Clones one iteration's body, substituting the loop variable for
+    // the element binding and renaming body-local declarations.
+    class Cloner {
+    public:
+        Cloner(Module& module, Symbol var, Symbol elem, uint32_t id)
+            : module_(module), var_(var), elem_(elem), id_(id) {}
+
+        Stmt* clone(const Stmt* stmt) {
+            switch (stmt->kind) {
+            case StmtKind::VarDecl: {
+                const auto* decl = static_cast<const VarDeclStmt*>(stmt);
+                VarDeclStmt* copy =
+                    module_.make<VarDeclStmt>(decl->line, decl->col);
+                copy->is_count = decl->is_count;
+                copy->is_soa = decl->is_soa;
+                copy->name = rename(decl->name);
+                copy->type_name = decl->type_name;
+                copy->init = clone(decl->init);
+                return copy;
+            }
+            case StmtKind::Spawn: {
+                const auto* spawn = static_cast<const SpawnStmt*>(stmt);
+                SpawnStmt* copy =
+                    module_.make<SpawnStmt>(spawn->line, spawn->col);
+                copy->call = static_cast<CallExpr*>(
+                    clone(static_cast<const Expr*>(spawn->call)));
+                return copy;
+            }
+            case StmtKind::Each: {
+                const auto* each = static_cast<const EachStmt*>(stmt);
+                EachStmt* copy =
+                    module_.make<EachStmt>(each->line, each->col);
+                copy->var = each->var;
+                copy->seq = clone(each->seq);
+                std::vector<Stmt*> inner;
+                for (const Stmt* nested : each->body)
+                    inner.push_back(clone(nested));
+                copy->body = module_.arena.copy_span(inner);
+                return copy;
+            }
+            case StmtKind::Expr: {
+                const auto* expr_stmt = static_cast<const ExprStmt*>(stmt);
+                ExprStmt* copy =
+                    module_.make<ExprStmt>(expr_stmt->line, expr_stmt->col);
+                copy->expr = clone(expr_stmt->expr);
+                return copy;
+            }
+            }
+            return nullptr;
+        }
+
+        Expr* clone(const Expr* expr) {
+            switch (expr->kind) {
+            case ExprKind::Ident: {
+                const auto* ident = static_cast<const IdentExpr*>(expr);
+                IdentExpr* copy =
+                    module_.make<IdentExpr>(ident->line, ident->col);
+                copy->name = ident->name == var_ ? elem_
+                                                 : renamed(ident->name);
+                return copy;
+            }
+            case ExprKind::Call: {
+                const auto* call = static_cast<const CallExpr*>(expr);
+                CallExpr* copy =
+                    module_.make<CallExpr>(call->line, call->col);
+                copy->callee = call->callee;
+                std::vector<Expr*> args;
+                for (const Expr* arg : call->args)
+                    args.push_back(clone(arg));
+                copy->args = module_.arena.copy_span(args);
+                return copy;
+            }
+            case ExprKind::Field: {
+                const auto* access = static_cast<const FieldExpr*>(expr);
+                FieldExpr* copy =
+                    module_.make<FieldExpr>(access->line, access->col);
+                copy->base = clone(access->base);
+                copy->field = access->field;
+                return copy;
+            }
+            case ExprKind::ArrayLit: {
+                const auto* array =
+                    static_cast<const ArrayLitExpr*>(expr);
+                ArrayLitExpr* copy =
+                    module_.make<ArrayLitExpr>(array->line, array->col);
+                std::vector<Expr*> elems;
+                for (const Expr* elem : array->elems)
+                    elems.push_back(clone(elem));
+                copy->elems = module_.arena.copy_span(elems);
+                return copy;
+            }
+            default:
+                // Literals are immutable; sharing nodes across
+                // iterations is safe.
+                return const_cast<Expr*>(expr);
+            }
+        }
+
+    private:
+        Symbol rename(Symbol name) {
+            Symbol fresh = intern(std::string(sym_text(name)) + "$" +
+                                  std::to_string(id_));
+            renames_.emplace(name, fresh);
+            return fresh;
+        }
+
+        Symbol renamed(Symbol name) const {
+            auto it = renames_.find(name);
+            return it != renames_.end() ? it->second : name;
+        }
+
+        Module& module_;
+        Symbol var_;
+        Symbol elem_;
+        uint32_t id_;
+        std::unordered_map<Symbol, Symbol> renames_;
+    };
+
+    // Whole arrays never appear as values: they cannot be printed,
+    // passed, or assigned into scalars.
+    void check_no_arrays(const Stmt& stmt) const {
+        switch (stmt.kind) {
+        case StmtKind::VarDecl:
+            check_no_arrays(*static_cast<const VarDeclStmt&>(stmt).init);
+            break;
+        case StmtKind::Spawn:
+            check_no_arrays(*static_cast<const SpawnStmt&>(stmt).call);
+            break;
+        case StmtKind::Expr:
+            check_no_arrays(*static_cast<const ExprStmt&>(stmt).expr);
+            break;
+        case StmtKind::Each:
+            break; // expanded before reaching here
+        }
+    }
+
+    void check_no_arrays(const Expr& expr) const {
+        switch (expr.kind) {
+        case ExprKind::Ident: {
+            const auto& ident = static_cast<const IdentExpr&>(expr);
+            if (arrays_.count(ident.name))
+                fail(ident, "array '" +
+                                std::string(sym_text(ident.name)) +
+                                "' used as a value; iterate it with "
+                                "'each'");
+            break;
+        }
+        case ExprKind::Call:
+            for (const Expr* arg :
+                 static_cast<const CallExpr&>(expr).args)
+                check_no_arrays(*arg);
+            break;
+        case ExprKind::Field:
+            check_no_arrays(*static_cast<const FieldExpr&>(expr).base);
+            break;
+        case ExprKind::ArrayLit:
+            fail(expr, "array literal outside a binding or 'each'");
+        default:
+            break;
+        }
+    }
+
+    Symbol elem_name(std::string_view array, uint32_t index) const {
+        return intern(std::string(array) + "." + std::to_string(index));
+    }
+
+    [[noreturn]] void fail(const Node& at, const std::string& msg) const {
+        error(module_.file_name, at.line, at.col, msg);
+        throw CompileError();
+    }
+
+    Module& module_;
+    std::unordered_map<Symbol, uint32_t> arrays_; // name -> element count
+    uint32_t next_id_ = 0;
+};
+
+} // namespace
+
+void expand_batches(Module& module) {
+    BatchExpander(module).run();
+}
+
+namespace {
+
+// Sort key for one @soa leaf binding: "ps.3.pos.x" orders by the field
+// path ("pos.x") before the element index (3), which is exactly the
+// transposed, field-major layout.
+struct SoaKey {
+    std::string_view array;
+    std::string_view field;
+    uint64_t index = 0;
+};
+
+bool soa_key(std::string_view name, SoaKey& key) {
+    // The element index is the first all-digit dotted segment.
+    size_t pos = 0;
+    while (pos < name.size()) {
+        size_t dot = name.find('.', pos);
+        if (dot == std::string_view::npos)
+            return false;
+        size_t end = name.find('.', dot + 1);
+        std::string_view seg = name.substr(
+            dot + 1,
+            (end == std::string_view::npos ? name.size() : end) - dot - 1);
+        bool digits = !seg.empty();
+        for (char c : seg)
+            digits = digits && c >= '0' && c <= '9';
+        if (digits) {
+            key.array = name.substr(0, dot);
+            key.field =
+                end == std::string_view::npos ? "" : name.substr(end + 1);
+            key.index = 0;
+            for (char c : seg)
+                key.index = key.index * 10 + (uint64_t)(c - '0');
+            return true;
+        }
+        pos = dot + 1;
+    }
+    return false;
+}
+
+} // namespace
+
+void transpose_soa(Module& module) {
+    for (FunDecl* fun : module.functions) {
+        std::vector<Stmt*> body(fun->body.begin(), fun->body.end());
+        size_t i = 0;
+        bool changed = false;
+        while (i < body.size()) {
+            if (body[i]->kind != StmtKind::VarDecl ||
+                !static_cast<VarDeclStmt*>(body[i])->is_soa) {
+                i++;
+                continue;
+            }
+            // A maximal run of @soa leaf bindings; reordering is safe
+            // because initializers are side-effect-free values.
+            size_t end = i;
+            while (end < body.size() &&
+                   body[end]->kind == StmtKind::VarDecl &&
+                   static_cast<VarDeclStmt*>(body[end])->is_soa)
+                end++;
+            std::stable_sort(
+                body.begin() + (ptrdiff_t)i, body.begin() + (ptrdiff_t)end,
+                [](const Stmt* a, const Stmt* b) {
+                    SoaKey ka, kb;
+                    if (!soa_key(sym_text(
+                                     static_cast<const VarDeclStmt*>(a)->name),
+                                 ka) ||
+                        !soa_key(sym_text(
+                                     static_cast<const VarDeclStmt*>(b)->name),
+                                 kb))
+                        return false;
+                    if (ka.array != kb.array)
+                        return false; // keep distinct arrays in order
+                    if (ka.field != kb.field)
+                        return ka.field < kb.field;
+                    return ka.index < kb.index;
+                });
+            changed = true;
+            i = end;
+        }
+        if (changed)
+            fun->body = module.arena.copy_span(body);
+    }
+}
+
+} // namespace wave
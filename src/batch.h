@@ -0,0 +1,41 @@
+#pragma once
+
+#include "ast.h"
+
+namespace wave {
+
+// Batch expansion for arrays and `each` loops, run before struct
+// expansion and type checking.
+//
+// An array literal is a fixed-size value sequence; its length is part
+// of the program text, so the compiler knows every element at compile
+// time. This pass splices arrays and their loops away entirely:
+//
+//   var ps = [a, b, c]          one binding per element ("ps.0", ...)
+//   var qs = ps                 per-element moves, no copy of a box
+//   each p in ps { ... }        body repeated once per element
+//
+// The `each` body is cloned per element with the loop variable bound
+// to that element's bindings and body-local names renamed, which is
+// what guarantees the advertised lowering: a single linear sweep in
+// element order, fully unrolled, with no bounds checks, no iterator
+// object, and no allocation. Elements flow into the struct pass next,
+// so an array of structs decomposes to per-field scalar bindings and
+// vector-typed fields keep their packed SSE arithmetic — the codegen
+// of a hand-unrolled SoA loop.
+//
+// Arrays are compile-time values only: they cannot be printed whole,
+// passed to functions, or used as scalars. Throws CompileError on
+// malformed array code.
+void expand_batches(Module& module);
+
+// Applies `@soa` layout, run after struct expansion. An @soa array's
+// flattened leaf bindings are reordered field-major — every element's
+// `pos.x` before any element's `vel.x` — so the registers and frame
+// slots later stages assign in binding order form parallel per-field
+// arrays. Field-access syntax is untouched (bindings resolve by name,
+// not position); only the layout transposes, which keeps a sweep that
+// reads one field of a wide struct on densely packed cache lines.
+void transpose_soa(Module& module);
+
+} // namespace wave
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "ast.h"
+#include "interner.h"
+#include "profile.h"
+
+namespace wave {
+
+// Register-based bytecode for the interpreter tier. Instructions are a
+// fixed 4 bytes; each function owns a dense window of registers and calls
+// overlap callee frames onto the caller's argument registers, Lua-style,
+// so a call moves no values.
+
+enum class Op : uint8_t {
+    LoadK,    // r[a] = constants[c]
+    Move,     // r[a] = r[c]
+    PrintLit, // write interned literal constants[c]
+    PrintInt, // write integer r[a]
+    PrintF32, // write float r[a]
+    PrintStr, // write string r[a]
+    PrintVec, // write vector r[a] as "(x, y, ...)"
+    VSet,     // r[a].lane[c >> 8] = float value of r[c & 0xff]
+    VAdd,     // r[a] = r[a] + r[c], all lanes at once
+    VMul,     // r[a] = r[a] * r[c], all lanes at once
+    Substr,   // r[a] = view of r[c]'s bytes [r[c+1], r[c+1] + r[c+2])
+    Call,     // call functions[c]; args already sit at frame base r[a]
+    Spawn,    // run functions[c] as a task; args copied from r[a]..
+    Join,     // wait for this frame's spawned tasks (structured join)
+    Ret,      // return from current function
+    Frame,    // frame-boundary mark for the sampler (`frame()` builtin)
+};
+
+struct Insn {
+    Op op;
+    uint8_t a = 0;
+    uint16_t c = 0;
+};
+static_assert(sizeof(Insn) == 4, "instructions stay cache-dense");
+
+// Runtime value: integers and floats are immediate; strings are
+// borrowed pointer+length slices over interned bytes, so copying or
+// passing one moves two words and never allocates, and sub-slicing is
+// pointer arithmetic. Vector lanes sit in a 16-byte-aligned array so
+// the component-wise ops compile to single packed SSE/NEON
+// instructions; unused high lanes stay zero.
+struct Value {
+    Type tag = Type::Void;
+    int64_t int_v = 0;
+    const char* str_data = nullptr;
+    uint32_t str_len = 0;
+    float f32_v = 0;
+    alignas(16) float vec_v[4] = {0, 0, 0, 0};
+
+    static Value make_int(int64_t v) {
+        Value value;
+        value.tag = Type::Int;
+        value.int_v = v;
+        return value;
+    }
+    static Value make_f32(float v) {
+        Value value;
+        value.tag = Type::Float;
+        value.f32_v = v;
+        return value;
+    }
+    static Value make_str(Symbol v) {
+        return make_str(sym_text(v).data(), (uint32_t)sym_text(v).size());
+    }
+    static Value make_str(const char* data, uint32_t len) {
+        Value value;
+        value.tag = Type::Str;
+        value.str_data = data;
+        value.str_len = len;
+        return value;
+    }
+    static Value make_vec(Type tag, const float* lanes) {
+        Value value;
+        value.tag = tag;
+        for (uint32_t l = 0; l < vec_lanes(tag); l++)
+            value.vec_v[l] = lanes[l];
+        return value;
+    }
+};
+
+struct BcFunction {
+    Symbol name = kNoSymbol;
+    uint8_t num_params = 0;
+    uint8_t num_regs = 0; // locals + temporaries
+    std::vector<Insn> code;
+    std::vector<Value> constants;
+};
+
+struct BcProgram {
+    std::vector<BcFunction> functions;
+    std::unordered_map<Symbol, uint16_t> by_name;
+    uint16_t main_index = UINT16_MAX;
+};
+
+// Lowers an analyzed module to bytecode, running the inlining pass
+// first. Instrumented (--profile-generate) builds skip inlining so call
+// counts describe the program as written, not its optimized form.
+// Throws CompileError if the module has no 'main' or a function needs
+// more registers than the encoding allows.
+BcProgram lower_module(Module& module, const ProfileData* profile = nullptr,
+                       bool instrumented = false);
+
+// Disassembles `program` to stdout ('wave disasm').
+void dump_program(const BcProgram& program);
+
+} // namespace wave
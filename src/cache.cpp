@@ -0,0 +1,88 @@
+#include "cache.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+
+#include <sys/stat.h>
+
+#include "ast.h"
+#include "modfile.h"
+
+namespace wave {
+
+uint64_t content_hash(std::string_view source) {
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&](unsigned char byte) {
+        hash ^= byte;
+        hash *= 1099511628211ull;
+    };
+    for (char c : source)
+        mix((unsigned char)c);
+    mix((unsigned char)kModVersion); // toolchain upgrade invalidates all
+    return hash;
+}
+
+CompileCache::CompileCache(std::string dir) : dir_(std::move(dir)) {
+    ::mkdir(dir_.c_str(), 0755);
+}
+
+CompileCache CompileCache::open_default() {
+    const char* env = std::getenv("WAVE_CACHE_DIR");
+    return CompileCache(env ? env : ".wave-cache");
+}
+
+std::string CompileCache::entry_path(uint64_t key) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.wvm", (unsigned long long)key);
+    return dir_ + "/" + name;
+}
+
+bool CompileCache::load(uint64_t key, UnitSummary& summary) const {
+    // Entries are .wvm modules: validation is a header check and reading
+    // a signature touches only its pages.
+    MappedModule mod;
+    if (!mod.open(entry_path(key)))
+        return false;
+
+    summary.functions.clear();
+    for (uint32_t f = 0; f < mod.fun_count(); f++) {
+        const ModFun& fun = mod.fun(f);
+        FunSig sig;
+        sig.name = intern(mod.string(fun.name));
+        for (uint32_t p = 0; p < fun.param_count; p++) {
+            const ModParam& param = mod.param(fun, p);
+            sig.params.emplace_back(intern(mod.string(param.name)),
+                                    intern(mod.string(param.type_name)));
+        }
+        summary.functions.push_back(std::move(sig));
+    }
+    return true;
+}
+
+void CompileCache::store(uint64_t key, const UnitSummary& summary) const {
+    std::string bytes = write_module_bytes(summary);
+    std::string path = entry_path(key);
+    std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out)
+            return; // cache is best-effort; a failed store is a later miss
+        out.write(bytes.data(), (std::streamsize)bytes.size());
+    }
+    std::rename(tmp.c_str(), path.c_str());
+}
+
+UnitSummary summarize_module(const Module& module) {
+    UnitSummary summary;
+    for (const FunDecl* fun : module.functions) {
+        FunSig sig;
+        sig.name = fun->name;
+        for (const Param& param : fun->params)
+            sig.params.emplace_back(param.name, param.type_name);
+        summary.functions.push_back(std::move(sig));
+    }
+    return summary;
+}
+
+} // namespace wave
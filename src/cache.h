@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "interner.h"
+
+namespace wave {
+
+struct Module;
+
+// The post-sema artifact the driver keeps per compilation unit: the
+// signatures a unit exports to its importers. Units whose source bytes
+// are unchanged reload this from the on-disk cache instead of being
+// re-lexed, re-parsed and re-checked.
+struct FunSig {
+    Symbol name = kNoSymbol;
+    std::vector<std::pair<Symbol, Symbol>> params; // (name, type name)
+};
+
+struct UnitSummary {
+    std::vector<FunSig> functions;
+};
+
+// 64-bit FNV-1a over the unit's source bytes; the cache key. Mixing in
+// the format version means a toolchain upgrade invalidates everything.
+uint64_t content_hash(std::string_view source);
+
+// On-disk cache in WAVE_CACHE_DIR (default ".wave-cache"). Entries are
+// written atomically via rename, so concurrent driver workers can share a
+// directory.
+class CompileCache {
+public:
+    explicit CompileCache(std::string dir);
+
+    // Returns true and fills `summary` if an entry for `key` exists and
+    // parses cleanly; a corrupt entry is treated as a miss.
+    bool load(uint64_t key, UnitSummary& summary) const;
+    void store(uint64_t key, const UnitSummary& summary) const;
+
+    // Opens the cache at WAVE_CACHE_DIR or the default location.
+    static CompileCache open_default();
+
+private:
+    std::string entry_path(uint64_t key) const;
+
+    std::string dir_;
+};
+
+// Extracts the exported signatures of an analyzed module.
+UnitSummary summarize_module(const Module& module);
+
+} // namespace wave
@@ -0,0 +1,26 @@
+#include "consteval.h"
+
+namespace wave {
+
+ConstInfo analyze_consts(const FunDecl& fun) {
+    ConstInfo info;
+    for (const Stmt* stmt : fun.body) {
+        if (stmt->kind != StmtKind::VarDecl)
+            continue;
+        const auto& decl = static_cast<const VarDeclStmt&>(*stmt);
+        if (!decl.is_count)
+            continue;
+        if (decl.init->kind == ExprKind::IntLit) {
+            info.const_ints.emplace(
+                decl.name, static_cast<const IntLitExpr*>(decl.init)->value);
+        } else if (decl.init->kind == ExprKind::Ident) {
+            auto it = info.const_ints.find(
+                static_cast<const IdentExpr*>(decl.init)->name);
+            if (it != info.const_ints.end())
+                info.const_ints.emplace(decl.name, it->second);
+        }
+    }
+    return info;
+}
+
+} // namespace wave
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+
+#include "ast.h"
+
+namespace wave {
+
+// Compile-time evaluation of `count` bindings.
+//
+// `count` is the language's immutable binding form, so any count whose
+// initializer is evaluable at compile time is a true constant: it costs
+// zero bytes at runtime and every use site folds to its value. Today
+// "evaluable" means an integer literal or a reference to an earlier
+// constant count; arithmetic joins the evaluator when the language grows
+// operators.
+struct ConstInfo {
+    std::unordered_map<Symbol, int64_t> const_ints; // count name -> value
+};
+
+ConstInfo analyze_consts(const FunDecl& fun);
+
+} // namespace wave
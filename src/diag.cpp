@@ -0,0 +1,19 @@
+#include "diag.h"
+
+#include <cstdio>
+#include <mutex>
+
+namespace wave {
+
+// Serializes diagnostics from the parallel driver's workers so messages
+// from different files do not interleave.
+static std::mutex diag_mutex;
+
+void error(std::string_view file, uint32_t line, uint32_t col,
+           const std::string& msg) {
+    std::lock_guard<std::mutex> lock(diag_mutex);
+    std::fprintf(stderr, "%.*s:%u:%u: error: %s\n", (int)file.size(),
+                 file.data(), line, col, msg.c_str());
+}
+
+} // namespace wave
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+namespace wave {
+
+// Thrown on the first unrecoverable front-end error; the driver catches it
+// and exits nonzero. The message has already been printed by error().
+struct CompileError : std::runtime_error {
+    CompileError() : std::runtime_error("compile error") {}
+};
+
+// Prints "file:line:col: error: msg" to stderr.
+void error(std::string_view file, uint32_t line, uint32_t col,
+           const std::string& msg);
+
+} // namespace wave
@@ -0,0 +1,252 @@
+#include "driver.h"
+
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#include <sys/resource.h>
+
+#include "diag.h"
+#include "lexer.h"
+#include "parser.h"
+#include "sema.h"
+
+namespace wave {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double seconds_since(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+bool read_file(const std::string& path, std::string& out) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+        return false;
+    std::ostringstream buf;
+    buf << in.rdbuf();
+    out = buf.str();
+    return true;
+}
+
+void compile_one(CompileUnit& unit, const CompileCache* cache) {
+    auto start = Clock::now();
+    std::string source;
+    if (!read_file(unit.path, source)) {
+        std::fprintf(stderr, "wave: cannot open '%s'\n", unit.path.c_str());
+        unit.failed = true;
+        return;
+    }
+    unit.read_time = seconds_since(start);
+
+    uint64_t key = 0;
+    if (cache) {
+        key = content_hash(source);
+        if (cache->load(key, unit.summary)) {
+            unit.cache_hit = true;
+            return;
+        }
+    }
+
+    unit.module = std::make_unique<Module>();
+    unit.module->file_name = unit.module->arena.copy_string(unit.path);
+    try {
+        start = Clock::now();
+        Lexer lexer(unit.path, source);
+        std::vector<Token> tokens = lexer.lex_all();
+        unit.lex_time = seconds_since(start);
+
+        start = Clock::now();
+        Parser parser(unit.path, std::move(tokens), *unit.module);
+        parser.parse_module();
+        unit.parse_time = seconds_since(start);
+
+        start = Clock::now();
+        analyze_module(*unit.module);
+        unit.sema_time = seconds_since(start);
+
+        unit.arena_bytes = unit.module->arena.bytes_used();
+        unit.summary = summarize_module(*unit.module);
+        if (cache)
+            cache->store(key, unit.summary);
+    } catch (const CompileError&) {
+        unit.failed = true;
+    }
+}
+
+// Work-stealing scheduler over compilation units. Each worker owns a deque
+// seeded round-robin; it pops from its own back and steals from other
+// workers' fronts when empty. Units gated on imports would be pushed when
+// their last dependency finishes; with no imports yet, every unit is ready
+// at the start.
+class Scheduler {
+public:
+    Scheduler(std::vector<CompileUnit>& units, const CompileCache* cache,
+              int workers)
+        : units_(units), cache_(cache), queues_(workers),
+          queue_mutexes_(workers) {
+        for (size_t i = 0; i < units.size(); i++)
+            queues_[i % workers].push_back(i);
+        remaining_ = units.size();
+    }
+
+    void run() {
+        std::vector<std::thread> threads;
+        for (size_t w = 0; w < queues_.size(); w++)
+            threads.emplace_back([this, w] { work(w); });
+        for (std::thread& thread : threads)
+            thread.join();
+    }
+
+private:
+    void work(size_t self) {
+        while (remaining_.load(std::memory_order_acquire) > 0) {
+            size_t unit_index;
+            if (!pop_own(self, unit_index) && !steal(self, unit_index)) {
+                std::this_thread::yield();
+                continue;
+            }
+            compile_one(units_[unit_index], cache_);
+            remaining_.fetch_sub(1, std::memory_order_release);
+        }
+    }
+
+    bool pop_own(size_t self, size_t& out) {
+        std::lock_guard<std::mutex> lock(queue_mutexes_[self]);
+        if (queues_[self].empty())
+            return false;
+        out = queues_[self].back();
+        queues_[self].pop_back();
+        return true;
+    }
+
+    bool steal(size_t self, size_t& out) {
+        for (size_t i = 1; i < queues_.size(); i++) {
+            size_t victim = (self + i) % queues_.size();
+            std::lock_guard<std::mutex> lock(queue_mutexes_[victim]);
+            if (queues_[victim].empty())
+                continue;
+            out = queues_[victim].front();
+            queues_[victim].pop_front();
+            return true;
+        }
+        return false;
+    }
+
+    std::vector<CompileUnit>& units_;
+    const CompileCache* cache_;
+    std::vector<std::deque<size_t>> queues_;
+    std::deque<std::mutex> queue_mutexes_;
+    std::atomic<size_t> remaining_{0};
+};
+
+// Peak resident set size in bytes (Linux reports kilobytes).
+size_t peak_rss_bytes() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+    return (size_t)usage.ru_maxrss * 1024;
+}
+
+void print_time_report(const std::vector<CompileUnit>& units, int workers,
+                       double wall, const DriverOptions& options) {
+    std::fprintf(stderr,
+                 "%-32s %9s %9s %9s %9s %10s\n", "unit", "read", "lex",
+                 "parse", "sema", "arena");
+    for (const CompileUnit& unit : units) {
+        if (unit.cache_hit) {
+            std::fprintf(stderr, "%-32s %s\n", unit.path.c_str(),
+                         "(cache hit)");
+            continue;
+        }
+        std::fprintf(stderr, "%-32s %8.3fms %8.3fms %8.3fms %8.3fms %9zuB\n",
+                     unit.path.c_str(), unit.read_time * 1e3,
+                     unit.lex_time * 1e3, unit.parse_time * 1e3,
+                     unit.sema_time * 1e3, unit.arena_bytes);
+    }
+    std::fprintf(stderr,
+                 "total: %zu unit(s), %d worker(s), %.3fs wall, peak RSS "
+                 "%zu KB, interner %zu symbol(s) / %zu bytes\n",
+                 units.size(), workers, wall, peak_rss_bytes() / 1024,
+                 Interner::global().size(), Interner::global().bytes_used());
+
+    if (options.time_report_json.empty())
+        return;
+    std::ofstream json(options.time_report_json, std::ios::trunc);
+    if (!json) {
+        std::fprintf(stderr, "wave: cannot write '%s'\n",
+                     options.time_report_json.c_str());
+        return;
+    }
+    json << "{\n  \"wall_seconds\": " << wall
+         << ",\n  \"workers\": " << workers
+         << ",\n  \"peak_rss_bytes\": " << peak_rss_bytes()
+         << ",\n  \"units\": [\n";
+    for (size_t i = 0; i < units.size(); i++) {
+        const CompileUnit& unit = units[i];
+        json << "    {\"path\": \"" << unit.path << "\", \"cache_hit\": "
+             << (unit.cache_hit ? "true" : "false")
+             << ", \"read_s\": " << unit.read_time
+             << ", \"lex_s\": " << unit.lex_time
+             << ", \"parse_s\": " << unit.parse_time
+             << ", \"sema_s\": " << unit.sema_time
+             << ", \"arena_bytes\": " << unit.arena_bytes << "}"
+             << (i + 1 < units.size() ? "," : "") << "\n";
+    }
+    json << "  ]\n}\n";
+}
+
+} // namespace
+
+bool compile_files(std::vector<CompileUnit>& units,
+                   const DriverOptions& options) {
+    int workers = options.jobs > 0
+                      ? options.jobs
+                      : (int)std::thread::hardware_concurrency();
+    if (workers < 1)
+        workers = 1;
+    if ((size_t)workers > units.size() && !units.empty())
+        workers = (int)units.size();
+
+    CompileCache cache = CompileCache::open_default();
+
+    auto start = Clock::now();
+    Scheduler(units, options.use_cache ? &cache : nullptr, workers).run();
+    double wall = seconds_since(start);
+
+    bool ok = true;
+    size_t hits = 0;
+    double read = 0, lex = 0, parse = 0, sema = 0;
+    for (const CompileUnit& unit : units) {
+        ok &= !unit.failed;
+        hits += unit.cache_hit;
+        read += unit.read_time;
+        lex += unit.lex_time;
+        parse += unit.parse_time;
+        sema += unit.sema_time;
+    }
+
+    if (options.timing) {
+        std::fprintf(stderr,
+                     "timing: %zu unit(s), %d worker(s), %.3fs wall\n"
+                     "  read  %.3fs\n  lex   %.3fs\n  parse %.3fs\n"
+                     "  sema  %.3fs\n",
+                     units.size(), workers, wall, read, lex, parse, sema);
+        if (options.use_cache)
+            std::fprintf(stderr, "cache: %zu hit(s), %zu miss(es)\n", hits,
+                         units.size() - hits);
+    }
+    if (options.time_report)
+        print_time_report(units, workers, wall, options);
+    return ok;
+}
+
+} // namespace wave
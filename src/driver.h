@@ -0,0 +1,49 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ast.h"
+#include "cache.h"
+
+namespace wave {
+
+struct DriverOptions {
+    int jobs = 0;          // 0 = hardware concurrency
+    bool timing = false;   // print per-phase wall time totals to stderr
+    bool use_cache = true; // consult the on-disk incremental cache
+
+    // --time-report: per-unit, per-phase table on stderr plus peak RSS
+    // and allocation counts; optionally also machine-readable JSON.
+    bool time_report = false;
+    std::string time_report_json; // path for JSON output, empty = none
+};
+
+// One compilation unit tracked by the driver. Units whose imports are all
+// compiled are ready to schedule; today Wave has no import syntax, so
+// every unit starts with zero unresolved dependencies, but the scheduler
+// is written against the graph so imports only have to add edges.
+struct CompileUnit {
+    std::string path;
+    std::unique_ptr<Module> module; // null when served from the cache
+    UnitSummary summary;
+    bool failed = false;
+    bool cache_hit = false;
+
+    // Wall time per phase, in seconds.
+    double read_time = 0;
+    double lex_time = 0;
+    double parse_time = 0;
+    double sema_time = 0;
+
+    // Allocation footprint: AST arena high-water bytes for this unit.
+    size_t arena_bytes = 0;
+};
+
+// Parses and analyzes every file on a work-stealing worker pool, honoring
+// dependency order between units. Returns false if any unit failed.
+bool compile_files(std::vector<CompileUnit>& units,
+                   const DriverOptions& options);
+
+} // namespace wave
@@ -0,0 +1,56 @@
+#include "escape.h"
+
+namespace wave {
+
+namespace {
+
+// Walks an expression marking bindings whose use lets them outlive the
+// frame. Call arguments are copied by value into the callee's frame and
+// Wave has no globals, stores, or returns yet, so no use here escapes;
+// the traversal exists so future constructs have one place to hook.
+void scan_expr(const Expr* expr, EscapeInfo& info) {
+    switch (expr->kind) {
+    case ExprKind::Call:
+        for (const Expr* arg : static_cast<const CallExpr*>(expr)->args)
+            scan_expr(arg, info);
+        break;
+    case ExprKind::Print:
+        for (const PrintOp& op : static_cast<const PrintExpr*>(expr)->ops)
+            if (op.arg)
+                scan_expr(op.arg, info);
+        break;
+    case ExprKind::IntLit:
+    case ExprKind::FloatLit:
+    case ExprKind::StrLit:
+    case ExprKind::Ident:
+    case ExprKind::Field:    // rewritten away before this pass
+    case ExprKind::ArrayLit: // rewritten away before this pass
+        break;
+    }
+}
+
+} // namespace
+
+EscapeInfo analyze_escapes(const FunDecl& fun) {
+    EscapeInfo info;
+    for (const Stmt* stmt : fun.body) {
+        if (stmt->kind == StmtKind::VarDecl) {
+            const auto& decl = static_cast<const VarDeclStmt&>(*stmt);
+            if (decl.init->kind == ExprKind::StrLit)
+                info.static_strings.emplace(
+                    decl.name,
+                    static_cast<const StrLitExpr*>(decl.init)->value);
+            else
+                scan_expr(decl.init, info);
+        } else if (stmt->kind == StmtKind::Spawn) {
+            // Spawned arguments are copied into the task by value and
+            // the task joins before the frame dies, so nothing escapes.
+            scan_expr(static_cast<const SpawnStmt*>(stmt)->call, info);
+        } else {
+            scan_expr(static_cast<const ExprStmt*>(stmt)->expr, info);
+        }
+    }
+    return info;
+}
+
+} // namespace wave
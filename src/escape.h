@@ -0,0 +1,30 @@
+#pragma once
+
+#include <unordered_map>
+
+#include "ast.h"
+
+namespace wave {
+
+// Frame-escape analysis for one function's bindings.
+//
+// A binding escapes its frame if a reference to it can outlive the frame:
+// stored into a longer-lived object, captured, or returned. For the
+// language as it stands none of those constructs exist — passing a value
+// to a call copies it into the callee's frame — so the analysis proves
+// most bindings frame-local; it is written as a use-walk so new escape
+// points (returns, stores, closures) only have to mark the binding.
+//
+// The payoff today: a non-escaping string binding initialized from a
+// literal needs no runtime storage at all. The lowerer replaces it with a
+// static reference to the interned literal — no register, no copy, and a
+// print of it becomes a literal write.
+struct EscapeInfo {
+    // Non-escaping string locals whose value is a compile-time literal,
+    // mapped to that literal's symbol.
+    std::unordered_map<Symbol, Symbol> static_strings;
+};
+
+EscapeInfo analyze_escapes(const FunDecl& fun);
+
+} // namespace wave
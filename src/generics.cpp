@@ -0,0 +1,145 @@
+#include "generics.h"
+
+#include <string>
+
+namespace wave {
+
+namespace {
+
+using Bindings = std::unordered_map<Symbol, Type>;
+
+// Deep copy of a template body into a specialization. Later stages
+// mutate statements in place (print lowering, inlining), so a
+// specialization never shares nodes with its template or with sibling
+// specializations. Type-parameter annotations on local bindings are
+// substituted here; everything else copies verbatim.
+Expr* clone_expr(Module& module, const Expr* expr);
+
+Stmt* clone_stmt(Module& module, const Bindings& bindings,
+                 const Stmt* stmt) {
+    if (stmt->kind == StmtKind::Spawn) {
+        const auto* spawn = static_cast<const SpawnStmt*>(stmt);
+        SpawnStmt* copy = module.make<SpawnStmt>(spawn->line, spawn->col);
+        copy->call = static_cast<CallExpr*>(
+            clone_expr(module, static_cast<const Expr*>(spawn->call)));
+        return copy;
+    }
+    if (stmt->kind == StmtKind::VarDecl) {
+        const auto* decl = static_cast<const VarDeclStmt*>(stmt);
+        VarDeclStmt* copy = module.make<VarDeclStmt>(decl->line, decl->col);
+        copy->is_count = decl->is_count;
+        copy->name = decl->name;
+        copy->type_name = decl->type_name;
+        auto bound = bindings.find(decl->type_name);
+        if (bound != bindings.end())
+            copy->type_name = intern(type_text(bound->second));
+        copy->init = clone_expr(module, decl->init);
+        return copy;
+    }
+    const auto* expr_stmt = static_cast<const ExprStmt*>(stmt);
+    ExprStmt* copy = module.make<ExprStmt>(expr_stmt->line, expr_stmt->col);
+    copy->expr = clone_expr(module, expr_stmt->expr);
+    return copy;
+}
+
+Expr* clone_expr(Module& module, const Expr* expr) {
+    switch (expr->kind) {
+    case ExprKind::IntLit: {
+        const auto* lit = static_cast<const IntLitExpr*>(expr);
+        IntLitExpr* copy = module.make<IntLitExpr>(lit->line, lit->col);
+        copy->value = lit->value;
+        return copy;
+    }
+    case ExprKind::FloatLit: {
+        const auto* lit = static_cast<const FloatLitExpr*>(expr);
+        FloatLitExpr* copy = module.make<FloatLitExpr>(lit->line, lit->col);
+        copy->value = lit->value;
+        return copy;
+    }
+    case ExprKind::StrLit: {
+        const auto* lit = static_cast<const StrLitExpr*>(expr);
+        StrLitExpr* copy = module.make<StrLitExpr>(lit->line, lit->col);
+        copy->value = lit->value;
+        return copy;
+    }
+    case ExprKind::Ident: {
+        const auto* ident = static_cast<const IdentExpr*>(expr);
+        IdentExpr* copy = module.make<IdentExpr>(ident->line, ident->col);
+        copy->name = ident->name;
+        return copy;
+    }
+    case ExprKind::Call: {
+        const auto* call = static_cast<const CallExpr*>(expr);
+        CallExpr* copy = module.make<CallExpr>(call->line, call->col);
+        copy->callee = call->callee;
+        std::vector<Expr*> args;
+        for (const Expr* arg : call->args)
+            args.push_back(clone_expr(module, arg));
+        copy->args = module.arena.copy_span(args);
+        return copy;
+    }
+    case ExprKind::Field: {
+        const auto* access = static_cast<const FieldExpr*>(expr);
+        FieldExpr* copy = module.make<FieldExpr>(access->line, access->col);
+        copy->base = clone_expr(module, access->base);
+        copy->field = access->field;
+        return copy;
+    }
+    case ExprKind::ArrayLit:
+        break; // expanded away before checking
+    case ExprKind::Print:
+        break; // only exists after checking
+    }
+    return nullptr;
+}
+
+} // namespace
+
+std::string_view type_text(Type type) {
+    switch (type) {
+    case Type::Int:   return "i32";
+    case Type::Float: return "f32";
+    case Type::Str:   return "str";
+    case Type::Vec2:  return "vec2f";
+    case Type::Vec3:  return "vec3f";
+    case Type::Vec4:  return "vec4f";
+    case Type::Void:  return "void";
+    }
+    return "void";
+}
+
+FunDecl* GenericInstantiator::instantiate(const FunDecl& templ,
+                                          const Bindings& bindings) {
+    std::string mangled(sym_text(templ.name));
+    for (Symbol type_param : templ.type_params) {
+        mangled += '$';
+        mangled += type_text(bindings.at(type_param));
+    }
+    Symbol name = intern(mangled);
+    auto it = cache_.find(name);
+    if (it != cache_.end())
+        return it->second;
+
+    FunDecl* fun = module_.make<FunDecl>(templ.line, templ.col);
+    fun->is_async = templ.is_async;
+    fun->name = name;
+    std::vector<Param> params;
+    for (const Param& param : templ.params) {
+        Param copy = param;
+        auto bound = bindings.find(param.type_name);
+        if (bound != bindings.end())
+            copy.type_name = intern(type_text(bound->second));
+        params.push_back(copy);
+    }
+    fun->params = module_.arena.copy_span(params);
+    std::vector<Stmt*> body;
+    for (const Stmt* stmt : templ.body)
+        body.push_back(clone_stmt(module_, bindings, stmt));
+    fun->body = module_.arena.copy_span(body);
+
+    cache_.emplace(name, fun);
+    order_.push_back(fun);
+    return fun;
+}
+
+} // namespace wave
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include "ast.h"
+
+namespace wave {
+
+// Monomorphization for generic functions.
+//
+// `fun lerp[T](a :T, b :T)` declares a template; it is never compiled
+// itself. At each call site the checker deduces the type parameters
+// from the argument types and swaps the call over to a dedicated
+// specialization — a real FunDecl named `lerp$vec3f` whose annotations
+// are made concrete — so generic code over vec3f keeps the flat
+// 16-byte layout and packed SSE lowering of hand-written code, and the
+// inliner sees an ordinary small function. There is no boxed or
+// uniform-representation fallback.
+//
+// Specializations are cached by mangled name: a hundred call sites of
+// lerp over vec3f share one clone, which is what keeps monomorphization
+// from multiplying compile times. The on-disk incremental cache needs
+// no extra keying — specializations are deterministic outputs of module
+// source the cache already hashes.
+class GenericInstantiator {
+public:
+    explicit GenericInstantiator(Module& module) : module_(module) {}
+
+    // The specialization of `templ` with each type parameter bound per
+    // `bindings`; created and cached on first request.
+    FunDecl* instantiate(const FunDecl& templ,
+                         const std::unordered_map<Symbol, Type>& bindings);
+
+    // Every specialization created so far, in creation order.
+    const std::vector<FunDecl*>& instantiations() const { return order_; }
+
+private:
+    Module& module_;
+    std::unordered_map<Symbol, FunDecl*> cache_; // by mangled name
+    std::vector<FunDecl*> order_;
+};
+
+// The canonical source spelling of a concrete type ("i32", "vec3f",
+// ...), used for mangled names and substituted annotations.
+std::string_view type_text(Type type);
+
+} // namespace wave
@@ -0,0 +1,272 @@
+#include "inline.h"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace wave {
+
+namespace {
+
+// Size budget (in AST nodes) below which a callee is worth splicing into
+// its caller instead of paying call overhead and losing optimization
+// context across the boundary.
+constexpr uint32_t kInlineBudget = 24;
+
+// Rewrite rounds; caps expansion through chains of inlinable wrappers and
+// breaks mutual-recursion cycles.
+constexpr int kMaxRounds = 4;
+
+uint32_t expr_cost(const Expr* expr) {
+    switch (expr->kind) {
+    case ExprKind::Call: {
+        uint32_t cost = 2;
+        for (const Expr* arg : static_cast<const CallExpr*>(expr)->args)
+            cost += expr_cost(arg);
+        return cost;
+    }
+    case ExprKind::Print: {
+        uint32_t cost = 1;
+        for (const PrintOp& op : static_cast<const PrintExpr*>(expr)->ops)
+            cost += op.arg ? expr_cost(op.arg) : 1;
+        return cost;
+    }
+    default:
+        return 1;
+    }
+}
+
+const Expr* stmt_expr(const Stmt* stmt) {
+    switch (stmt->kind) {
+    case StmtKind::VarDecl:
+        return static_cast<const VarDeclStmt*>(stmt)->init;
+    case StmtKind::Spawn:
+        return static_cast<const SpawnStmt*>(stmt)->call;
+    case StmtKind::Expr:
+        return static_cast<const ExprStmt*>(stmt)->expr;
+    case StmtKind::Each:
+        break; // expanded away before inlining
+    }
+    return nullptr;
+}
+
+uint32_t fun_cost(const FunDecl& fun) {
+    uint32_t cost = 0;
+    for (const Stmt* stmt : fun.body) {
+        cost++;
+        if (const Expr* expr = stmt_expr(stmt))
+            cost += expr_cost(expr);
+    }
+    return cost;
+}
+
+bool calls_self(const Expr* expr, Symbol self) {
+    switch (expr->kind) {
+    case ExprKind::Call: {
+        const auto* call = static_cast<const CallExpr*>(expr);
+        if (call->callee == self)
+            return true;
+        for (const Expr* arg : call->args)
+            if (calls_self(arg, self))
+                return true;
+        return false;
+    }
+    case ExprKind::Print:
+        for (const PrintOp& op : static_cast<const PrintExpr*>(expr)->ops)
+            if (op.arg && calls_self(op.arg, self))
+                return true;
+        return false;
+    default:
+        return false;
+    }
+}
+
+bool is_recursive(const FunDecl& fun) {
+    for (const Stmt* stmt : fun.body) {
+        const Expr* expr = stmt_expr(stmt);
+        if (expr && calls_self(expr, fun.name))
+            return true;
+    }
+    return false;
+}
+
+// Clones a callee body into the caller's arena, renaming the callee's
+// locals to fresh symbols and substituting parameter references by the
+// (side-effect-free) argument expressions.
+class Cloner {
+public:
+    Cloner(Module& module, std::unordered_map<Symbol, const Expr*> subst)
+        : module_(module), subst_(std::move(subst)) {}
+
+    Stmt* clone(const Stmt* stmt) {
+        if (stmt->kind == StmtKind::Spawn) {
+            const auto* spawn = static_cast<const SpawnStmt*>(stmt);
+            SpawnStmt* copy =
+                module_.make<SpawnStmt>(spawn->line, spawn->col);
+            copy->call = static_cast<CallExpr*>(
+                clone(static_cast<const Expr*>(spawn->call)));
+            return copy;
+        }
+        if (stmt->kind == StmtKind::VarDecl) {
+            const auto* decl = static_cast<const VarDeclStmt*>(stmt);
+            VarDeclStmt* copy =
+                module_.make<VarDeclStmt>(decl->line, decl->col);
+            copy->is_count = decl->is_count;
+            copy->name = rename(decl->name);
+            copy->type_name = decl->type_name;
+            copy->init = clone(decl->init);
+            return copy;
+        }
+        const auto* expr_stmt = static_cast<const ExprStmt*>(stmt);
+        ExprStmt* copy =
+            module_.make<ExprStmt>(expr_stmt->line, expr_stmt->col);
+        copy->expr = clone(expr_stmt->expr);
+        return copy;
+    }
+
+    Expr* clone(const Expr* expr) {
+        switch (expr->kind) {
+        case ExprKind::IntLit: {
+            const auto* lit = static_cast<const IntLitExpr*>(expr);
+            IntLitExpr* copy = module_.make<IntLitExpr>(lit->line, lit->col);
+            copy->value = lit->value;
+            return copy;
+        }
+        case ExprKind::FloatLit: {
+            const auto* lit = static_cast<const FloatLitExpr*>(expr);
+            FloatLitExpr* copy =
+                module_.make<FloatLitExpr>(lit->line, lit->col);
+            copy->value = lit->value;
+            return copy;
+        }
+        case ExprKind::StrLit: {
+            const auto* lit = static_cast<const StrLitExpr*>(expr);
+            StrLitExpr* copy = module_.make<StrLitExpr>(lit->line, lit->col);
+            copy->value = lit->value;
+            return copy;
+        }
+        case ExprKind::Ident: {
+            const auto* ident = static_cast<const IdentExpr*>(expr);
+            auto it = subst_.find(ident->name);
+            // Specialize on the argument. The argument is caller-side
+            // code: copy it verbatim, with no substitution or renaming,
+            // or an argument named like the parameter recurses forever.
+            if (it != subst_.end())
+                return Cloner(module_, {}).clone(it->second);
+            IdentExpr* copy = module_.make<IdentExpr>(ident->line, ident->col);
+            copy->name = renamed(ident->name);
+            return copy;
+        }
+        case ExprKind::Call: {
+            const auto* call = static_cast<const CallExpr*>(expr);
+            CallExpr* copy = module_.make<CallExpr>(call->line, call->col);
+            copy->callee = call->callee;
+            std::vector<Expr*> args;
+            for (const Expr* arg : call->args)
+                args.push_back(clone(arg));
+            copy->args = module_.arena.copy_span(args);
+            return copy;
+        }
+        case ExprKind::Field: {
+            const auto* access = static_cast<const FieldExpr*>(expr);
+            FieldExpr* copy =
+                module_.make<FieldExpr>(access->line, access->col);
+            copy->base = clone(access->base);
+            copy->field = access->field;
+            return copy;
+        }
+        case ExprKind::ArrayLit:
+            break; // expanded away before inlining
+        case ExprKind::Print: {
+            const auto* print = static_cast<const PrintExpr*>(expr);
+            PrintExpr* copy = module_.make<PrintExpr>(print->line, print->col);
+            std::vector<PrintOp> ops;
+            for (const PrintOp& op : print->ops) {
+                PrintOp cloned = op;
+                if (op.arg)
+                    cloned.arg = clone(op.arg);
+                ops.push_back(cloned);
+            }
+            copy->ops = module_.arena.copy_span(ops);
+            return copy;
+        }
+        }
+        return nullptr;
+    }
+
+private:
+    Symbol rename(Symbol name) {
+        static uint32_t next_id = 0;
+        Symbol fresh = intern(std::string(sym_text(name)) + "$" +
+                              std::to_string(next_id++));
+        renames_.emplace(name, fresh);
+        return fresh;
+    }
+
+    Symbol renamed(Symbol name) const {
+        auto it = renames_.find(name);
+        return it != renames_.end() ? it->second : name;
+    }
+
+    Module& module_;
+    std::unordered_map<Symbol, const Expr*> subst_;
+    std::unordered_map<Symbol, Symbol> renames_;
+};
+
+} // namespace
+
+void inline_calls(Module& module, const ProfileData* profile) {
+    std::unordered_map<Symbol, const FunDecl*> functions;
+    for (const FunDecl* fun : module.functions)
+        functions.emplace(fun->name, fun);
+
+    for (int round = 0; round < kMaxRounds; round++) {
+        bool changed = false;
+        for (FunDecl* fun : module.functions) {
+            std::vector<Stmt*> body;
+            for (Stmt* stmt : fun->body) {
+                const CallExpr* call = nullptr;
+                if (stmt->kind == StmtKind::Expr) {
+                    const Expr* expr =
+                        static_cast<const ExprStmt*>(stmt)->expr;
+                    if (expr->kind == ExprKind::Call)
+                        call = static_cast<const CallExpr*>(expr);
+                }
+                // Builtin calls (vector ops, substr) have no FunDecl.
+                const FunDecl* callee = nullptr;
+                if (call) {
+                    auto it = functions.find(call->callee);
+                    callee = it != functions.end() ? it->second : nullptr;
+                }
+                uint32_t budget = kInlineBudget;
+                if (profile && callee) {
+                    if (profile->is_cold(callee->name))
+                        budget = 0; // never grow code for unexecuted paths
+                    else if (profile->is_hot(callee->name))
+                        budget *= 4;
+                }
+                if (!callee || callee->name == fun->name ||
+                    fun_cost(*callee) > budget || is_recursive(*callee)) {
+                    body.push_back(stmt);
+                    continue;
+                }
+
+                // Splice the callee body; arguments substitute directly
+                // for parameters (all argument forms are side-effect-free
+                // values today, so no binding statement is needed).
+                std::unordered_map<Symbol, const Expr*> subst;
+                for (uint32_t i = 0; i < callee->params.size(); i++)
+                    subst.emplace(callee->params[i].name, call->args[i]);
+                Cloner cloner(module, std::move(subst));
+                for (const Stmt* callee_stmt : callee->body)
+                    body.push_back(cloner.clone(callee_stmt));
+                changed = true;
+            }
+            fun->body = module.arena.copy_span(body);
+        }
+        if (!changed)
+            break;
+    }
+}
+
+} // namespace wave
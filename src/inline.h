@@ -0,0 +1,25 @@
+#pragma once
+
+#include "ast.h"
+#include "profile.h"
+
+namespace wave {
+
+// Inlines small `fun` bodies into their callers after sema.
+//
+// Wave functions return nothing yet, so every call is a statement and
+// inlining is statement splicing: the callee body is cloned into the
+// caller with its locals renamed and each parameter substituted by the
+// argument expression. Substituting a constant argument specializes the
+// inlined body for that value — the later constant-folding and
+// escape passes then fold it through, so a wrapper like
+// hello("LunaStev") melts into straight-line writes.
+//
+// Heuristics: a callee is inlined when its body costs at most
+// kInlineBudget nodes and it does not call itself directly; bounded
+// rewrite rounds keep mutually recursive cycles from expanding forever.
+// With a profile, hot callees get a widened budget and cold ones are
+// never inlined, so code growth is spent where the frames are.
+void inline_calls(Module& module, const ProfileData* profile = nullptr);
+
+} // namespace wave
@@ -0,0 +1,25 @@
+#include "interner.h"
+
+#include <mutex>
+
+namespace wave {
+
+Symbol Interner::intern(std::string_view text) {
+    std::unique_lock lock(mutex_);
+    auto it = map_.find(text);
+    if (it != map_.end())
+        return it->second;
+
+    std::string_view stored = storage_.copy_string(text);
+    Symbol sym = (Symbol)strings_.size();
+    strings_.push_back(stored);
+    map_.emplace(stored, sym);
+    return sym;
+}
+
+Interner& Interner::global() {
+    static Interner interner;
+    return interner;
+}
+
+} // namespace wave
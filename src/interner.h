@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <shared_mutex>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "arena.h"
+
+namespace wave {
+
+// A 32-bit handle to an interned string. Two symbols are equal iff their
+// spellings are equal, so name lookup and comparison during semantic
+// analysis are integer compares.
+using Symbol = uint32_t;
+constexpr Symbol kNoSymbol = UINT32_MAX;
+
+// Deduplicating string table shared by every compilation unit in the
+// process. Identifier and literal bytes are stored exactly once, in the
+// interner's own arena; symbols index into that storage for the life of
+// the build. Safe to use from the parallel driver's worker threads:
+// interning takes a writer lock, lookups a reader lock.
+class Interner {
+public:
+    Symbol intern(std::string_view text);
+    std::string_view text(Symbol sym) const {
+        std::shared_lock lock(mutex_);
+        return strings_[sym];
+    }
+    size_t size() const {
+        std::shared_lock lock(mutex_);
+        return strings_.size();
+    }
+    size_t bytes_used() const {
+        std::shared_lock lock(mutex_);
+        return storage_.bytes_used();
+    }
+
+    // The process-wide interner used by the whole toolchain.
+    static Interner& global();
+
+private:
+    mutable std::shared_mutex mutex_;
+    Arena storage_;
+    std::vector<std::string_view> strings_;
+    std::unordered_map<std::string_view, Symbol> map_;
+};
+
+// Convenience wrappers over the global interner.
+inline Symbol intern(std::string_view text) {
+    return Interner::global().intern(text);
+}
+inline std::string_view sym_text(Symbol sym) {
+    return Interner::global().text(sym);
+}
+
+} // namespace wave
@@ -0,0 +1,214 @@
+#include "lexer.h"
+
+#include <cctype>
+
+#include "diag.h"
+
+namespace wave {
+
+const char* token_kind_name(TokenKind kind) {
+    switch (kind) {
+    case TokenKind::Eof:       return "end of file";
+    case TokenKind::Ident:     return "identifier";
+    case TokenKind::Int:       return "integer literal";
+    case TokenKind::Float:     return "float literal";
+    case TokenKind::Str:       return "string literal";
+    case TokenKind::KwFun:     return "'fun'";
+    case TokenKind::KwAsync:   return "'async'";
+    case TokenKind::KwVar:     return "'var'";
+    case TokenKind::KwCount:   return "'count'";
+    case TokenKind::KwStruct:  return "'struct'";
+    case TokenKind::KwSpawn:   return "'spawn'";
+    case TokenKind::KwEach:    return "'each'";
+    case TokenKind::KwIn:      return "'in'";
+    case TokenKind::LParen:    return "'('";
+    case TokenKind::RParen:    return "')'";
+    case TokenKind::LBrace:    return "'{'";
+    case TokenKind::RBrace:    return "'}'";
+    case TokenKind::LBracket:  return "'['";
+    case TokenKind::RBracket:  return "']'";
+    case TokenKind::Colon:     return "':'";
+    case TokenKind::Comma:     return "','";
+    case TokenKind::Dot:       return "'.'";
+    case TokenKind::Semicolon: return "';'";
+    case TokenKind::Equal:     return "'='";
+    case TokenKind::At:        return "'@'";
+    }
+    return "?";
+}
+
+std::vector<Token> Lexer::lex_all() {
+    std::vector<Token> tokens;
+    tokens.reserve(src_.size() / 4 + 8); // rough tokens-per-byte estimate
+    for (;;) {
+        Token tok = next();
+        bool done = tok.kind == TokenKind::Eof;
+        tokens.push_back(std::move(tok));
+        if (done)
+            break;
+    }
+    return tokens;
+}
+
+char Lexer::peek(size_t ahead) const {
+    return pos_ + ahead < src_.size() ? src_[pos_ + ahead] : '\0';
+}
+
+char Lexer::advance() {
+    char c = src_[pos_++];
+    if (c == '\n') {
+        line_++;
+        col_ = 1;
+    } else {
+        col_++;
+    }
+    return c;
+}
+
+void Lexer::skip_trivia() {
+    for (;;) {
+        char c = peek();
+        if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+            advance();
+        } else if (c == '/' && peek(1) == '/') {
+            while (peek() != '\n' && peek() != '\0')
+                advance();
+        } else {
+            return;
+        }
+    }
+}
+
+Token Lexer::next() {
+    skip_trivia();
+
+    Token tok;
+    tok.line = line_;
+    tok.col = col_;
+
+    char c = peek();
+    if (c == '\0') {
+        tok.kind = TokenKind::Eof;
+        return tok;
+    }
+    if (std::isalpha((unsigned char)c) || c == '_')
+        return lex_ident_or_keyword();
+    if (std::isdigit((unsigned char)c))
+        return lex_number();
+    if (c == '"')
+        return lex_string();
+
+    advance();
+    switch (c) {
+    case '(': tok.kind = TokenKind::LParen; return tok;
+    case ')': tok.kind = TokenKind::RParen; return tok;
+    case '{': tok.kind = TokenKind::LBrace; return tok;
+    case '}': tok.kind = TokenKind::RBrace; return tok;
+    case '[': tok.kind = TokenKind::LBracket; return tok;
+    case ']': tok.kind = TokenKind::RBracket; return tok;
+    case ':': tok.kind = TokenKind::Colon; return tok;
+    case ',': tok.kind = TokenKind::Comma; return tok;
+    case '.': tok.kind = TokenKind::Dot; return tok;
+    case ';': tok.kind = TokenKind::Semicolon; return tok;
+    case '=': tok.kind = TokenKind::Equal; return tok;
+    case '@': tok.kind = TokenKind::At; return tok;
+    default:
+        fail(std::string("unexpected character '") + c + "'");
+    }
+}
+
+Token Lexer::lex_ident_or_keyword() {
+    Token tok;
+    tok.line = line_;
+    tok.col = col_;
+    size_t start = pos_;
+    while (std::isalnum((unsigned char)peek()) || peek() == '_')
+        advance();
+    std::string_view spelling = src_.substr(start, pos_ - start);
+
+    if (spelling == "fun") {
+        tok.kind = TokenKind::KwFun;
+    } else if (spelling == "async") {
+        tok.kind = TokenKind::KwAsync;
+    } else if (spelling == "var") {
+        tok.kind = TokenKind::KwVar;
+    } else if (spelling == "count") {
+        tok.kind = TokenKind::KwCount;
+    } else if (spelling == "struct") {
+        tok.kind = TokenKind::KwStruct;
+    } else if (spelling == "spawn") {
+        tok.kind = TokenKind::KwSpawn;
+    } else if (spelling == "each") {
+        tok.kind = TokenKind::KwEach;
+    } else if (spelling == "in") {
+        tok.kind = TokenKind::KwIn;
+    } else {
+        tok.kind = TokenKind::Ident;
+        tok.sym = intern(spelling);
+    }
+    return tok;
+}
+
+Token Lexer::lex_number() {
+    Token tok;
+    tok.kind = TokenKind::Int;
+    tok.line = line_;
+    tok.col = col_;
+    int64_t value = 0;
+    while (std::isdigit((unsigned char)peek()))
+        value = value * 10 + (advance() - '0');
+    // A '.' followed by a digit makes this a float literal.
+    if (peek() == '.' && std::isdigit((unsigned char)peek(1))) {
+        advance(); // '.'
+        double frac = 0, scale = 0.1;
+        while (std::isdigit((unsigned char)peek())) {
+            frac += (advance() - '0') * scale;
+            scale *= 0.1;
+        }
+        tok.kind = TokenKind::Float;
+        tok.float_value = (float)((double)value + frac);
+        return tok;
+    }
+    tok.int_value = value;
+    return tok;
+}
+
+Token Lexer::lex_string() {
+    Token tok;
+    tok.kind = TokenKind::Str;
+    tok.line = line_;
+    tok.col = col_;
+    advance(); // opening quote
+    std::string contents;
+    for (;;) {
+        char c = peek();
+        if (c == '\0' || c == '\n')
+            fail("unterminated string literal");
+        advance();
+        if (c == '"')
+            break;
+        if (c == '\\') {
+            char esc = peek();
+            advance();
+            switch (esc) {
+            case 'n':  contents += '\n'; break;
+            case 't':  contents += '\t'; break;
+            case '\\': contents += '\\'; break;
+            case '"':  contents += '"'; break;
+            default:
+                fail(std::string("unknown escape '\\") + esc + "'");
+            }
+        } else {
+            contents += c;
+        }
+    }
+    tok.sym = intern(contents);
+    return tok;
+}
+
+void Lexer::fail(const std::string& msg) const {
+    error(file_name_, line_, col_, msg);
+    throw CompileError();
+}
+
+} // namespace wave
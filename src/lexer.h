@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string_view>
+#include <vector>
+
+#include "token.h"
+
+namespace wave {
+
+// Hand-written lexer over a whole source buffer. One pass, no allocation
+// besides the token vector; keywords are recognized without a lookup table
+// allocation so lexing stays memory-bandwidth bound.
+class Lexer {
+public:
+    Lexer(std::string_view file_name, std::string_view source)
+        : file_name_(file_name), src_(source) {}
+
+    // Lexes the entire buffer. Reports errors through wave::error() and
+    // throws CompileError on the first malformed token.
+    std::vector<Token> lex_all();
+
+private:
+    Token next();
+    char peek(size_t ahead = 0) const;
+    char advance();
+    void skip_trivia();
+    Token lex_ident_or_keyword();
+    Token lex_number();
+    Token lex_string();
+    [[noreturn]] void fail(const std::string& msg) const;
+
+    std::string_view file_name_;
+    std::string_view src_;
+    size_t pos_ = 0;
+    uint32_t line_ = 1;
+    uint32_t col_ = 1;
+};
+
+} // namespace wave
@@ -0,0 +1,467 @@
+#include <string>
+
+#include "bytecode.h"
+#include "diag.h"
+#include "consteval.h"
+#include "escape.h"
+#include "inline.h"
+#include "task.h"
+
+namespace wave {
+
+namespace {
+
+std::string format_f32(float value);
+
+// Lowers one function: named bindings get the low registers, expression
+// temporaries stack above them and are released per statement.
+class FunctionLowerer {
+public:
+    FunctionLowerer(const Module& module, const BcProgram& program,
+                    const FunDecl& fun)
+        : module_(module), program_(program), fun_(fun) {}
+
+    BcFunction lower() {
+        escapes_ = analyze_escapes(fun_);
+        consts_ = analyze_consts(fun_);
+        out_.name = fun_.name;
+        out_.num_params = (uint8_t)fun_.params.size();
+        for (const Param& param : fun_.params)
+            bind_local(param.name);
+        for (const Stmt* stmt : fun_.body) {
+            lower_stmt(*stmt);
+            next_temp_ = num_locals_; // statement temporaries die here
+        }
+        if (has_spawn_)
+            emit(Op::Join, 0, 0); // structured: tasks end with the frame
+        emit(Op::Ret, 0, 0);
+        out_.num_regs = high_water_;
+        return std::move(out_);
+    }
+
+private:
+    void lower_stmt(const Stmt& stmt) {
+        if (stmt.kind == StmtKind::Spawn) {
+            const auto& call =
+                *static_cast<const SpawnStmt&>(stmt).call;
+            if (call.args.size() > kMaxTaskArgs)
+                fail("spawn supports at most " +
+                     std::to_string((int)kMaxTaskArgs) + " arguments");
+            uint8_t base = next_temp_;
+            for (const Expr* arg : call.args)
+                lower_expr_into(*arg, alloc_temp());
+            emit(Op::Spawn, base, program_.by_name.at(call.callee));
+            has_spawn_ = true;
+            return;
+        }
+        if (stmt.kind == StmtKind::VarDecl) {
+            const auto& decl = static_cast<const VarDeclStmt&>(stmt);
+            // Non-escaping literal strings and constant counts need no
+            // frame storage: uses fold to the value at compile time.
+            if (escapes_.static_strings.count(decl.name) ||
+                consts_.const_ints.count(decl.name))
+                return;
+            uint8_t reg = bind_local(decl.name);
+            lower_expr_into(*decl.init, reg);
+        } else {
+            const Expr* expr = static_cast<const ExprStmt&>(stmt).expr;
+            if (expr->kind == ExprKind::Print)
+                lower_print(static_cast<const PrintExpr&>(*expr));
+            else
+                lower_expr(*expr);
+        }
+    }
+
+    void lower_print(const PrintExpr& print) {
+        for (const PrintOp& op : print.ops) {
+            switch (op.kind) {
+            case PrintOpKind::WriteLit:
+                emit(Op::PrintLit, 0,
+                     add_constant(Value::make_str(op.literal)));
+                break;
+            case PrintOpKind::WriteInt: {
+                // A compile-time-constant integer is formatted now and
+                // printed as a literal segment.
+                int64_t value;
+                if (const_int(*op.arg, value))
+                    emit(Op::PrintLit, 0,
+                         add_constant(Value::make_str(
+                             intern(std::to_string(value)))));
+                else
+                    emit(Op::PrintInt, lower_expr(*op.arg), 0);
+                break;
+            }
+            case PrintOpKind::WriteFloat: {
+                // Float literals are likewise formatted at compile time.
+                if (op.arg->kind == ExprKind::FloatLit)
+                    emit(Op::PrintLit, 0,
+                         add_constant(Value::make_str(intern(format_f32(
+                             static_cast<const FloatLitExpr*>(op.arg)
+                                 ->value)))));
+                else
+                    emit(Op::PrintF32, lower_expr(*op.arg), 0);
+                break;
+            }
+            case PrintOpKind::WriteVec:
+                emit(Op::PrintVec, lower_expr(*op.arg), 0);
+                break;
+            case PrintOpKind::WriteStr: {
+                // A statically known string prints as a literal segment.
+                Symbol lit = static_string(*op.arg);
+                if (lit != kNoSymbol)
+                    emit(Op::PrintLit, 0, add_constant(Value::make_str(lit)));
+                else
+                    emit(Op::PrintStr, lower_expr(*op.arg), 0);
+                break;
+            }
+            }
+        }
+    }
+
+    // Evaluates `expr` into any register and returns it; named bindings
+    // are used in place without a copy.
+    uint8_t lower_expr(const Expr& expr) {
+        int64_t unused;
+        if (expr.kind == ExprKind::Ident &&
+            static_string(expr) == kNoSymbol && !const_int(expr, unused))
+            return local_reg(static_cast<const IdentExpr&>(expr));
+        uint8_t reg = alloc_temp();
+        lower_expr_into(expr, reg);
+        return reg;
+    }
+
+    // Returns the literal symbol if `expr` is a string whose value is
+    // known at compile time (a literal, or a binding escape analysis
+    // proved static), else kNoSymbol.
+    Symbol static_string(const Expr& expr) const {
+        if (expr.kind == ExprKind::StrLit)
+            return static_cast<const StrLitExpr&>(expr).value;
+        if (expr.kind == ExprKind::Ident) {
+            auto it = escapes_.static_strings.find(
+                static_cast<const IdentExpr&>(expr).name);
+            if (it != escapes_.static_strings.end())
+                return it->second;
+        }
+        return kNoSymbol;
+    }
+
+    // True (filling `value`) if `expr` is an integer known at compile
+    // time: a literal or a constant `count` binding.
+    bool const_int(const Expr& expr, int64_t& value) const {
+        if (expr.kind == ExprKind::IntLit) {
+            value = static_cast<const IntLitExpr&>(expr).value;
+            return true;
+        }
+        if (expr.kind == ExprKind::Ident) {
+            auto it = consts_.const_ints.find(
+                static_cast<const IdentExpr&>(expr).name);
+            if (it != consts_.const_ints.end()) {
+                value = it->second;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void lower_expr_into(const Expr& expr, uint8_t dst) {
+        switch (expr.kind) {
+        case ExprKind::IntLit:
+            emit(Op::LoadK, dst,
+                 add_constant(Value::make_int(
+                     static_cast<const IntLitExpr&>(expr).value)));
+            break;
+        case ExprKind::FloatLit:
+            emit(Op::LoadK, dst,
+                 add_constant(Value::make_f32(
+                     static_cast<const FloatLitExpr&>(expr).value)));
+            break;
+        case ExprKind::StrLit:
+            emit(Op::LoadK, dst,
+                 add_constant(Value::make_str(
+                     static_cast<const StrLitExpr&>(expr).value)));
+            break;
+        case ExprKind::Ident: {
+            Symbol lit = static_string(expr);
+            int64_t value;
+            if (lit != kNoSymbol)
+                emit(Op::LoadK, dst, add_constant(Value::make_str(lit)));
+            else if (const_int(expr, value))
+                emit(Op::LoadK, dst, add_constant(Value::make_int(value)));
+            else
+                emit(Op::Move, dst,
+                     local_reg(static_cast<const IdentExpr&>(expr)));
+            break;
+        }
+        case ExprKind::Call: {
+            const auto& call = static_cast<const CallExpr&>(expr);
+            Type vec = vec_ctor_type(sym_text(call.callee));
+            if (vec != Type::Void) {
+                lower_vec_ctor(call, vec, dst);
+                break;
+            }
+            if (is_vec_binop(sym_text(call.callee))) {
+                lower_expr_into(*call.args[0], dst);
+                uint8_t rhs = lower_expr(*call.args[1]);
+                emit(sym_text(call.callee) == "vadd" ? Op::VAdd : Op::VMul,
+                     dst, rhs);
+                break;
+            }
+            if (sym_text(call.callee) == "substr") {
+                lower_substr(call, dst);
+                break;
+            }
+            if (sym_text(call.callee) == "frame") {
+                emit(Op::Frame, 0, 0);
+                break;
+            }
+            // Args are evaluated into a fresh contiguous window that
+            // becomes the callee's frame base.
+            uint8_t base = next_temp_;
+            for (const Expr* arg : call.args)
+                lower_expr_into(*arg, alloc_temp());
+            emit(Op::Call, base, program_.by_name.at(call.callee));
+            break;
+        }
+        case ExprKind::Field:
+            fail("field access survived struct expansion"); // bug
+        case ExprKind::ArrayLit:
+            fail("array literal survived batch expansion"); // bug
+        case ExprKind::Print:
+            lower_print(static_cast<const PrintExpr&>(expr));
+            break;
+        }
+    }
+
+    // Constructors whose components are all compile-time constants fold
+    // to one vector constant; otherwise a zero vector is loaded and the
+    // runtime lanes are filled individually.
+    void lower_vec_ctor(const CallExpr& call, Type vec, uint8_t dst) {
+        float lanes[4] = {0, 0, 0, 0};
+        bool all_const = true;
+        for (uint32_t i = 0; i < call.args.size(); i++)
+            all_const = all_const && const_f32(*call.args[i], lanes[i]);
+        if (all_const) {
+            emit(Op::LoadK, dst, add_constant(Value::make_vec(vec, lanes)));
+            return;
+        }
+        float zero[4] = {0, 0, 0, 0};
+        emit(Op::LoadK, dst, add_constant(Value::make_vec(vec, zero)));
+        for (uint32_t i = 0; i < call.args.size(); i++) {
+            uint8_t src = lower_expr(*call.args[i]);
+            emit(Op::VSet, dst, (uint16_t)((i << 8) | src));
+        }
+    }
+
+    // Slicing is pointer arithmetic over borrowed bytes, so a slice of
+    // a compile-time string with compile-time bounds folds to one
+    // constant; otherwise source and bounds go into a contiguous window
+    // the runtime op reads.
+    void lower_substr(const CallExpr& call, uint8_t dst) {
+        Symbol src = static_string(*call.args[0]);
+        int64_t start, len;
+        if (src != kNoSymbol && const_int(*call.args[1], start) &&
+            const_int(*call.args[2], len)) {
+            std::string_view bytes = sym_text(src);
+            if (start < 0 || (uint64_t)start > bytes.size())
+                start = start < 0 ? 0 : (int64_t)bytes.size();
+            if (len < 0 || (uint64_t)len > bytes.size() - (uint64_t)start)
+                len = len < 0 ? 0 : (int64_t)(bytes.size() - (uint64_t)start);
+            emit(Op::LoadK, dst,
+                 add_constant(Value::make_str(bytes.data() + start,
+                                              (uint32_t)len)));
+            return;
+        }
+        uint8_t base = next_temp_;
+        for (const Expr* arg : call.args)
+            lower_expr_into(*arg, alloc_temp());
+        emit(Op::Substr, dst, base);
+    }
+
+    // True (filling `value`) if `expr` is a float knowable at compile
+    // time: a float or int literal, or a constant `count` binding.
+    bool const_f32(const Expr& expr, float& value) const {
+        if (expr.kind == ExprKind::FloatLit) {
+            value = static_cast<const FloatLitExpr&>(expr).value;
+            return true;
+        }
+        int64_t int_value;
+        if (const_int(expr, int_value)) {
+            value = (float)int_value;
+            return true;
+        }
+        return false;
+    }
+
+    uint8_t local_reg(const IdentExpr& ident) const {
+        return locals_.at(ident.name);
+    }
+
+    uint8_t bind_local(Symbol name) {
+        uint8_t reg = alloc_temp();
+        locals_.emplace(name, reg);
+        num_locals_ = next_temp_;
+        return reg;
+    }
+
+    uint8_t alloc_temp() {
+        if (next_temp_ == UINT8_MAX)
+            fail("function needs more than 255 registers");
+        uint8_t reg = next_temp_++;
+        if (next_temp_ > high_water_)
+            high_water_ = next_temp_;
+        return reg;
+    }
+
+    uint16_t add_constant(Value value) {
+        if (out_.constants.size() >= UINT16_MAX)
+            fail("function has more than 65535 constants");
+        out_.constants.push_back(value);
+        return (uint16_t)(out_.constants.size() - 1);
+    }
+
+    void emit(Op op, uint8_t a, uint16_t c) {
+        out_.code.push_back(Insn{op, a, c});
+    }
+
+    [[noreturn]] void fail(const std::string& msg) const {
+        error(module_.file_name, fun_.line, fun_.col, msg);
+        throw CompileError();
+    }
+
+    const Module& module_;
+    const BcProgram& program_;
+    const FunDecl& fun_;
+    EscapeInfo escapes_;
+    ConstInfo consts_;
+    BcFunction out_;
+    std::unordered_map<Symbol, uint8_t> locals_;
+    uint8_t num_locals_ = 0;
+    uint8_t next_temp_ = 0;
+    uint8_t high_water_ = 0;
+    bool has_spawn_ = false;
+};
+
+std::string format_f32(float value) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%g", (double)value);
+    return buf;
+}
+
+} // namespace
+
+BcProgram lower_module(Module& module, const ProfileData* profile,
+                       bool instrumented) {
+    if (!instrumented)
+        inline_calls(module, profile);
+
+    BcProgram program;
+    Symbol sym_main = intern("main");
+    for (const FunDecl* fun : module.functions) {
+        uint16_t index = (uint16_t)program.functions.size();
+        program.by_name.emplace(fun->name, index);
+        if (fun->name == sym_main)
+            program.main_index = index;
+        program.functions.emplace_back(); // filled below; index fixed now
+    }
+    if (program.main_index == UINT16_MAX) {
+        error(module.file_name, 1, 1, "no 'main' function");
+        throw CompileError();
+    }
+    for (uint32_t i = 0; i < module.functions.size(); i++)
+        program.functions[i] =
+            FunctionLowerer(module, program, *module.functions[i]).lower();
+    return program;
+}
+
+void dump_program(const BcProgram& program) {
+    for (const BcFunction& fn : program.functions) {
+        std::string_view name = sym_text(fn.name);
+        std::printf("fun %.*s: %u reg(s), %zu insn(s)\n", (int)name.size(),
+                    name.data(), fn.num_regs, fn.code.size());
+        for (size_t i = 0; i < fn.code.size(); i++) {
+            const Insn& insn = fn.code[i];
+            switch (insn.op) {
+            case Op::LoadK: {
+                const Value& k = fn.constants[insn.c];
+                if (k.tag == Type::Int) {
+                    std::printf("  %3zu  loadk    r%u, %lld\n", i, insn.a,
+                                (long long)k.int_v);
+                } else if (k.tag == Type::Float) {
+                    std::printf("  %3zu  loadk    r%u, %g\n", i, insn.a,
+                                (double)k.f32_v);
+                } else if (vec_lanes(k.tag)) {
+                    std::printf("  %3zu  loadk    r%u, vec%uf(", i, insn.a,
+                                vec_lanes(k.tag));
+                    for (uint32_t l = 0; l < vec_lanes(k.tag); l++)
+                        std::printf("%s%g", l ? ", " : "",
+                                    (double)k.vec_v[l]);
+                    std::printf(")\n");
+                } else {
+                    std::printf("  %3zu  loadk    r%u, \"%.*s\"\n", i, insn.a,
+                                (int)k.str_len, k.str_data);
+                }
+                break;
+            }
+            case Op::Move:
+                std::printf("  %3zu  move     r%u, r%u\n", i, insn.a, insn.c);
+                break;
+            case Op::PrintLit:
+                std::printf("  %3zu  printlit \"%.*s\"\n", i,
+                            (int)fn.constants[insn.c].str_len,
+                            fn.constants[insn.c].str_data);
+                break;
+            case Op::PrintInt:
+                std::printf("  %3zu  printint r%u\n", i, insn.a);
+                break;
+            case Op::PrintF32:
+                std::printf("  %3zu  printf32 r%u\n", i, insn.a);
+                break;
+            case Op::PrintVec:
+                std::printf("  %3zu  printvec r%u\n", i, insn.a);
+                break;
+            case Op::VSet:
+                std::printf("  %3zu  vset     r%u[%u], r%u\n", i, insn.a,
+                            insn.c >> 8, insn.c & 0xff);
+                break;
+            case Op::VAdd:
+                std::printf("  %3zu  vadd     r%u, r%u\n", i, insn.a, insn.c);
+                break;
+            case Op::VMul:
+                std::printf("  %3zu  vmul     r%u, r%u\n", i, insn.a, insn.c);
+                break;
+            case Op::PrintStr:
+                std::printf("  %3zu  printstr r%u\n", i, insn.a);
+                break;
+            case Op::Substr:
+                std::printf("  %3zu  substr   r%u, src r%u\n", i, insn.a,
+                            insn.c);
+                break;
+            case Op::Call: {
+                std::string_view callee =
+                    sym_text(program.functions[insn.c].name);
+                std::printf("  %3zu  call     %.*s, base r%u\n", i,
+                            (int)callee.size(), callee.data(), insn.a);
+                break;
+            }
+            case Op::Spawn: {
+                std::string_view callee =
+                    sym_text(program.functions[insn.c].name);
+                std::printf("  %3zu  spawn    %.*s, args r%u\n", i,
+                            (int)callee.size(), callee.data(), insn.a);
+                break;
+            }
+            case Op::Join:
+                std::printf("  %3zu  join\n", i);
+                break;
+            case Op::Ret:
+                std::printf("  %3zu  ret\n", i);
+                break;
+            case Op::Frame:
+                std::printf("  %3zu  frame\n", i);
+                break;
+            }
+        }
+    }
+}
+
+} // namespace wave
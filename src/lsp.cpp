@@ -0,0 +1,274 @@
+#include "lsp.h"
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "cache.h"
+#include "diag.h"
+#include "lexer.h"
+#include "parser.h"
+#include "sema.h"
+
+namespace wave {
+
+namespace {
+
+// One top-level declaration's span in the source, hashed for change
+// detection. Chunks are found textually — brace depth with string and
+// comment awareness — so splitting never needs a full lex.
+struct Chunk {
+    uint32_t first_line = 0;
+    uint32_t last_line = 0;
+    uint64_t hash = 0;
+    bool is_struct = false;
+    std::string_view text;
+};
+
+std::vector<Chunk> split_chunks(std::string_view source) {
+    std::vector<Chunk> chunks;
+    size_t start = std::string_view::npos;
+    uint32_t line = 1, start_line = 0;
+    int depth = 0;
+    for (size_t i = 0; i < source.size(); i++) {
+        char c = source[i];
+        if (c == '\n') {
+            line++;
+            continue;
+        }
+        if (c == '/' && i + 1 < source.size() && source[i + 1] == '/') {
+            while (i < source.size() && source[i] != '\n')
+                i++;
+            line++;
+            continue;
+        }
+        if (c == '"') {
+            for (i++; i < source.size() && source[i] != '"'; i++)
+                if (source[i] == '\\')
+                    i++;
+            continue;
+        }
+        if (start == std::string_view::npos && c != ' ' && c != '\t' &&
+            c != '\r') {
+            start = i;
+            start_line = line;
+        }
+        if (c == '{') {
+            depth++;
+        } else if (c == '}' && --depth == 0) {
+            Chunk chunk;
+            chunk.first_line = start_line;
+            chunk.last_line = line;
+            chunk.text = source.substr(start, i + 1 - start);
+            chunk.hash = content_hash(chunk.text);
+            chunk.is_struct = chunk.text.rfind("struct", 0) == 0;
+            chunks.push_back(chunk);
+            start = std::string_view::npos;
+        }
+    }
+    return chunks;
+}
+
+// What every function's check implicitly depends on: struct layouts and
+// the signature line of each declaration. While this matches the last
+// good check, an unchanged chunk's result is still valid.
+uint64_t deps_hash(const std::vector<Chunk>& chunks) {
+    std::string deps;
+    for (const Chunk& chunk : chunks) {
+        if (chunk.is_struct)
+            deps += chunk.text;
+        else
+            deps += chunk.text.substr(0, chunk.text.find('{'));
+        deps += '\n';
+    }
+    return content_hash(deps);
+}
+
+// A declaration as written in the source, captured right after the
+// parse. Analysis rewrites the module — struct params flatten to their
+// leaves, generic templates give way to $-mangled specializations — so
+// hover and completion answer from this snapshot, never from the
+// analyzed function list.
+struct DeclSig {
+    std::string name;
+    std::string signature;
+    uint32_t line = 0;
+};
+
+std::vector<DeclSig> snapshot_decls(const Module& module) {
+    std::vector<DeclSig> decls;
+    for (const StructDecl* decl : module.structs) {
+        DeclSig sig;
+        sig.name = sym_text(decl->name);
+        sig.signature = "struct " + sig.name;
+        sig.line = decl->line;
+        decls.push_back(std::move(sig));
+    }
+    for (const FunDecl* fun : module.functions) {
+        DeclSig sig;
+        sig.name = sym_text(fun->name);
+        sig.line = fun->line;
+        sig.signature = fun->is_async ? "async fun " : "fun ";
+        sig.signature += sig.name;
+        if (fun->type_params.size()) {
+            sig.signature += '[';
+            for (uint32_t i = 0; i < fun->type_params.size(); i++) {
+                if (i)
+                    sig.signature += ", ";
+                sig.signature += sym_text(fun->type_params[i]);
+            }
+            sig.signature += ']';
+        }
+        sig.signature += '(';
+        for (uint32_t i = 0; i < fun->params.size(); i++) {
+            if (i)
+                sig.signature += ", ";
+            sig.signature += sym_text(fun->params[i].name);
+            sig.signature += " :";
+            sig.signature += sym_text(fun->params[i].type_name);
+        }
+        sig.signature += ')';
+        decls.push_back(std::move(sig));
+    }
+    return decls;
+}
+
+struct FileState {
+    std::string source;
+    // Declared signatures from the last good check, for queries.
+    std::vector<DeclSig> decls;
+    std::unordered_set<uint64_t> clean_chunks;
+    uint64_t deps = 0;
+};
+
+class Server {
+public:
+    Server(std::FILE* in, std::FILE* out) : in_(in), out_(out) {}
+
+    int run() {
+        char line[4096];
+        while (std::fgets(line, sizeof(line), in_)) {
+            std::istringstream req(line);
+            std::string verb, path, arg;
+            req >> verb >> path >> arg;
+            if (verb == "quit")
+                break;
+            if (verb == "check")
+                check(path);
+            else if (verb == "hover")
+                hover(path, (uint32_t)std::strtoul(arg.c_str(), nullptr, 10));
+            else if (verb == "complete")
+                complete(path, arg);
+            else
+                reply("error unknown request '%s'", verb.c_str());
+        }
+        return 0;
+    }
+
+private:
+    void check(const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            reply("error cannot open '%s'", path.c_str());
+            return;
+        }
+        std::ostringstream buf;
+        buf << in.rdbuf();
+
+        FileState& state = files_[path];
+        std::string source = buf.str();
+        std::vector<Chunk> chunks = split_chunks(source);
+        uint64_t deps = deps_hash(chunks);
+
+        Module module;
+        module.file_name = module.arena.copy_string(path);
+        try {
+            Lexer lexer(path, source);
+            Parser parser(path, lexer.lex_all(), module);
+            parser.parse_module();
+        } catch (const CompileError&) {
+            reply("error");
+            return;
+        }
+        std::vector<DeclSig> decls = snapshot_decls(module);
+
+        // Functions whose chunk and dependencies both match the last
+        // good check are skipped wholesale; their previous result
+        // stands. An edit to one function re-checks one function.
+        std::unordered_set<Symbol> dirty;
+        uint32_t reused = 0;
+        for (const FunDecl* fun : module.functions) {
+            const Chunk* chunk = nullptr;
+            for (const Chunk& candidate : chunks)
+                if (candidate.first_line <= fun->line &&
+                    fun->line <= candidate.last_line)
+                    chunk = &candidate;
+            if (deps == state.deps && chunk &&
+                state.clean_chunks.count(chunk->hash))
+                reused++;
+            else
+                dirty.insert(fun->name);
+        }
+        uint32_t total = module.functions.size();
+        try {
+            analyze_module(module, dirty);
+        } catch (const CompileError&) {
+            // Previous clean chunks stay valid: deps_ is only advanced
+            // on success, so they still describe the last good check.
+            reply("error");
+            return;
+        }
+
+        state.source = std::move(source);
+        state.decls = std::move(decls);
+        state.deps = deps;
+        state.clean_chunks.clear();
+        for (const Chunk& chunk : chunks)
+            state.clean_chunks.insert(chunk.hash);
+        reply("ok %u %u %u", total, (uint32_t)dirty.size(), reused);
+    }
+
+    void hover(const std::string& path, uint32_t line) {
+        const FileState& state = files_[path];
+        const DeclSig* best = nullptr;
+        for (const DeclSig& decl : state.decls)
+            if (decl.line <= line && (!best || decl.line > best->line))
+                best = &decl;
+        reply("%s", best ? best->signature.c_str() : "none");
+    }
+
+    void complete(const std::string& path, const std::string& prefix) {
+        const FileState& state = files_[path];
+        std::string names;
+        for (const DeclSig& decl : state.decls) {
+            if (decl.name.compare(0, prefix.size(), prefix) != 0)
+                continue;
+            if (!names.empty())
+                names += ' ';
+            names += decl.name;
+        }
+        reply("%s", names.empty() ? "none" : names.c_str());
+    }
+
+    template <class... Args>
+    void reply(const char* fmt, Args... args) {
+        std::fprintf(out_, fmt, args...);
+        std::fputc('\n', out_);
+        std::fflush(out_); // the editor waits on each answer
+    }
+
+    std::FILE* in_;
+    std::FILE* out_;
+    std::unordered_map<std::string, FileState> files_;
+};
+
+} // namespace
+
+int run_lsp_server(std::FILE* in, std::FILE* out) {
+    return Server(in, out).run();
+}
+
+} // namespace wave
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdio>
+
+namespace wave {
+
+// Long-lived analysis server behind `wave lsp`.
+//
+// Editors re-check on every keystroke, and paying a cold batch compile
+// per diagnostic pass burns a core and seconds of latency. The server
+// stays resident instead and makes each check incremental at function
+// granularity: the file is split into top-level declaration chunks and
+// hashed, and only functions whose chunk changed — or whose module-wide
+// dependencies (struct layouts, function signatures) changed — are
+// re-typechecked. Everything the process accumulates is reused across
+// edits: the interner only grows, the declared signatures from the last
+// good parse are retained for queries, and chunk hashes carry over so
+// an edit to one function re-checks one function.
+//
+// The protocol is line-based on stdin/stdout, one request per line:
+//
+//   check <file>              diagnose; replies "ok <funs> <checked>
+//                             <reused>" or "error" (diagnostics go to
+//                             stderr in the usual compiler format)
+//   hover <file> <line>       the signature enclosing a source line
+//   complete <file> <prefix>  declared names starting with <prefix>
+//   quit
+//
+// Answers for hover/complete come from signatures captured at parse
+// time — before analysis rewrites the module — so they cost a lookup,
+// not a compile, and always show declarations as written in the
+// source. An LSP JSON-RPC front end can frame these verbs without
+// touching the analysis side.
+int run_lsp_server(std::FILE* in, std::FILE* out);
+
+} // namespace wave
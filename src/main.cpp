@@ -0,0 +1,411 @@
+#include <cstdio>
+#include <fstream>
+#include <vector>
+#include <sstream>
+#include <string>
+
+#include <chrono>
+#include <thread>
+
+#include "diag.h"
+#include "lexer.h"
+#include "lsp.h"
+#include "driver.h"
+#include "modfile.h"
+#include "reload.h"
+#include "sampler.h"
+#include "snapshot.h"
+#include "parser.h"
+#include "sema.h"
+#include "bytecode.h"
+#include "vm.h"
+#include "aot.h"
+#include "profile.h"
+
+namespace wave {
+
+static bool read_file(const std::string& path, std::string& out) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+        return false;
+    std::ostringstream buf;
+    buf << in.rdbuf();
+    out = buf.str();
+    return true;
+}
+
+static int cmd_parse(const std::string& path, bool arena_stats) {
+    std::string source;
+    if (!read_file(path, source)) {
+        std::fprintf(stderr, "wave: cannot open '%s'\n", path.c_str());
+        return 1;
+    }
+
+    Module module;
+    module.file_name = module.arena.copy_string(path);
+    try {
+        Lexer lexer(path, source);
+        Parser parser(path, lexer.lex_all(), module);
+        parser.parse_module();
+        analyze_module(module);
+    } catch (const CompileError&) {
+        return 1;
+    }
+    dump_module(module);
+    if (arena_stats)
+        std::fprintf(stderr,
+                     "arena: %zu bytes used (high water), %zu reserved in "
+                     "%zu chunk(s)\n",
+                     module.arena.bytes_used(), module.arena.bytes_reserved(),
+                     module.arena.chunk_count());
+    return 0;
+}
+
+// Front end for single-file commands: read, lex, parse, analyze.
+static bool compile_single(const std::string& path, Module& module) {
+    std::string source;
+    if (!read_file(path, source)) {
+        std::fprintf(stderr, "wave: cannot open '%s'\n", path.c_str());
+        return false;
+    }
+    module.file_name = module.arena.copy_string(path);
+    try {
+        Lexer lexer(path, source);
+        Parser parser(path, lexer.lex_all(), module);
+        parser.parse_module();
+        analyze_module(module);
+    } catch (const CompileError&) {
+        return false;
+    }
+    return true;
+}
+
+// Shared --profile-generate/--profile-use parsing for the commands that
+// compile code. Returns false on an unreadable profile.
+struct ProfileFlags {
+    bool generate = false;
+    std::string generate_path = kDefaultProfilePath;
+    ProfileData use_data;
+    const ProfileData* use = nullptr;
+};
+
+static bool parse_profile_flag(const std::string& arg, ProfileFlags& flags) {
+    if (arg == "--profile-generate") {
+        flags.generate = true;
+        return true;
+    }
+    if (arg.rfind("--profile-generate=", 0) == 0) {
+        flags.generate = true;
+        flags.generate_path = arg.substr(19);
+        return true;
+    }
+    if (arg.rfind("--profile-use=", 0) == 0) {
+        std::string path = arg.substr(14);
+        if (!flags.use_data.load(path)) {
+            std::fprintf(stderr, "wave: cannot read profile '%s'\n",
+                         path.c_str());
+            return false;
+        }
+        flags.use = &flags.use_data;
+        return true;
+    }
+    return false;
+}
+
+// Compiles and lowers a program once, writing the finished image so
+// later runs skip the whole front end.
+static int cmd_snapshot(const std::string& input, const std::string& output) {
+    Module module;
+    if (!compile_single(input, module))
+        return 1;
+    std::string bytes;
+    try {
+        bytes = write_snapshot_bytes(lower_module(module));
+    } catch (const CompileError&) {
+        return 1;
+    }
+    std::ofstream out(output, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::fprintf(stderr, "wave: cannot write '%s'\n", output.c_str());
+        return 1;
+    }
+    out.write(bytes.data(), (std::streamsize)bytes.size());
+    return 0;
+}
+
+// Cold-start path: map a snapshot image and jump to main with no
+// parsing, analysis or lowering in the loop.
+static int cmd_run_snapshot(const std::string& path) {
+    MappedSnapshot snapshot;
+    BcProgram program;
+    if (!snapshot.load(path, program)) {
+        std::fprintf(stderr, "wave: '%s' is not a valid snapshot\n",
+                     path.c_str());
+        return 1;
+    }
+    return run_program(program, nullptr);
+}
+
+// Live-iteration tier: drives `main` once per frame and lets the
+// reloader patch recompiled bodies in between, so a source edit shows
+// up in the running process in milliseconds with no restart. The frame
+// cadence here is the demo harness's; an engine embedding HotReloader
+// polls at its own frame boundary.
+static int cmd_run_hot(const std::string& path) {
+    Module module;
+    if (!compile_single(path, module))
+        return 1;
+    BcProgram program;
+    try {
+        program = lower_module(module);
+    } catch (const CompileError&) {
+        return 1;
+    }
+    HotReloader reloader(path);
+    for (;;) {
+        run_program(program, nullptr);
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        reloader.poll(program);
+    }
+}
+
+// Sampling tier: a normal bytecode run with the 1kHz profiler around
+// it; the collapsed stacks land in wave.folded for any flame viewer.
+static int cmd_run_sample(const std::string& path) {
+    Module module;
+    if (!compile_single(path, module))
+        return 1;
+    BcProgram program;
+    try {
+        program = lower_module(module);
+    } catch (const CompileError&) {
+        return 1;
+    }
+    Sampler::global().enable();
+    int rc = run_program(program, nullptr);
+    if (!Sampler::global().report("wave.folded"))
+        std::fprintf(stderr, "wave: cannot write 'wave.folded'\n");
+    return rc;
+}
+
+// Interpreter tier: lower to register bytecode and start executing
+// immediately; no native build in the loop.
+static int cmd_run(const ProfileFlags& flags, const std::string& path) {
+    Module module;
+    if (!compile_single(path, module))
+        return 1;
+    try {
+        ProfileData collected;
+        int rc = run_program(lower_module(module, flags.use, flags.generate),
+                             flags.generate ? &collected : nullptr);
+        if (flags.generate && !collected.save(flags.generate_path))
+            std::fprintf(stderr, "wave: cannot write profile '%s'\n",
+                         flags.generate_path.c_str());
+        return rc;
+    } catch (const CompileError&) {
+        return 1;
+    }
+}
+
+// AOT tier: emit a relocatable object linkable with a C++ engine.
+static int cmd_emit_obj(const ProfileFlags& flags, const std::string& input,
+                        const std::string& output) {
+    Module module;
+    if (!compile_single(input, module))
+        return 1;
+    std::string bytes;
+    try {
+        bytes = emit_object_x64(module, flags.use);
+    } catch (const CompileError&) {
+        return 1;
+    }
+    std::ofstream out(output, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::fprintf(stderr, "wave: cannot write '%s'\n", output.c_str());
+        return 1;
+    }
+    out.write(bytes.data(), (std::streamsize)bytes.size());
+    return 0;
+}
+
+static int cmd_disasm(const ProfileFlags& flags, const std::string& path) {
+    Module module;
+    if (!compile_single(path, module))
+        return 1;
+    try {
+        dump_program(lower_module(module, flags.use));
+    } catch (const CompileError&) {
+        return 1;
+    }
+    return 0;
+}
+
+static int cmd_build(int argc, char** argv) {
+    DriverOptions options;
+    std::vector<CompileUnit> units;
+    for (int i = 0; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-j" && i + 1 < argc) {
+            options.jobs = std::atoi(argv[++i]);
+        } else if (arg.rfind("-j", 0) == 0 && arg.size() > 2) {
+            options.jobs = std::atoi(arg.c_str() + 2);
+        } else if (arg == "--timing") {
+            options.timing = true;
+        } else if (arg == "--no-cache") {
+            options.use_cache = false;
+        } else if (arg == "--time-report") {
+            options.time_report = true;
+        } else if (arg.rfind("--time-report=", 0) == 0) {
+            options.time_report = true;
+            options.time_report_json = arg.substr(14);
+        } else {
+            CompileUnit unit;
+            unit.path = arg;
+            units.push_back(std::move(unit));
+        }
+    }
+    if (units.empty()) {
+        std::fprintf(stderr, "wave build: no input files\n");
+        return 2;
+    }
+    return compile_files(units, options) ? 0 : 1;
+}
+
+// Compiles one file and writes its exported interface as a .wvm module.
+static int cmd_emit_mod(const std::string& input, const std::string& output) {
+    DriverOptions options;
+    options.use_cache = false;
+    std::vector<CompileUnit> units(1);
+    units[0].path = input;
+    if (!compile_files(units, options))
+        return 1;
+    std::string bytes = write_module_bytes(units[0].summary);
+    std::ofstream out(output, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::fprintf(stderr, "wave: cannot write '%s'\n", output.c_str());
+        return 1;
+    }
+    out.write(bytes.data(), (std::streamsize)bytes.size());
+    return 0;
+}
+
+// Maps a .wvm module and prints the signatures it exports.
+static int cmd_modinfo(const std::string& path) {
+    MappedModule mod;
+    if (!mod.open(path)) {
+        std::fprintf(stderr, "wave: '%s' is not a valid module\n",
+                     path.c_str());
+        return 1;
+    }
+    std::printf("module %s: %u function(s)\n", path.c_str(),
+                mod.fun_count());
+    for (uint32_t f = 0; f < mod.fun_count(); f++) {
+        const ModFun& fun = mod.fun(f);
+        std::string_view name = mod.string(fun.name);
+        std::printf("  fun %.*s(", (int)name.size(), name.data());
+        for (uint32_t p = 0; p < fun.param_count; p++) {
+            const ModParam& param = mod.param(fun, p);
+            std::string_view pname = mod.string(param.name);
+            std::string_view ptype = mod.string(param.type_name);
+            std::printf("%s%.*s :%.*s", p ? ", " : "", (int)pname.size(),
+                        pname.data(), (int)ptype.size(), ptype.data());
+        }
+        std::printf(")\n");
+    }
+    return 0;
+}
+
+static int usage() {
+    std::fprintf(stderr,
+                 "usage: wave <command> [args]\n"
+                 "\n"
+                 "commands:\n"
+                 "  parse [--arena-stats] <file.wave>   parse a source file "
+                 "and dump its AST\n"
+                 "  build [-j N] [--timing] [--no-cache]\n"
+                 "        [--time-report[=out.json]] <files...>\n"
+                 "                                      compile files in "
+                 "parallel\n"
+                 "  run [profile flags] <file.wave>     compile to bytecode "
+                 "and execute\n"
+                 "  run --snapshot <app.img>            execute a snapshot "
+                 "image\n"
+                 "  run --hot <file.wave>               run per frame, "
+                 "hot-swapping edits\n"
+                 "  run --sample <file.wave>            run under the "
+                 "sampling profiler\n"
+                 "  disasm [profile flags] <file.wave>  dump lowered "
+                 "bytecode\n"
+                 "  emit-obj [profile flags] <file.wave> <out.o>\n"
+                 "                                      emit a native "
+                 "x86-64 object file\n"
+                 "\n"
+                 "profile flags: --profile-generate[=path] "
+                 "--profile-use=path\n"
+                 "  emit-mod <file.wave> <out.wvm>      write a binary "
+                 "interface module\n"
+                 "  modinfo <file.wvm>                  dump a binary "
+                 "module's exports\n"
+                 "  snapshot <file.wave> <app.img>      write a lowered "
+                 "program image\n"
+                 "  lsp                                 serve incremental "
+                 "analysis over stdio\n");
+    return 2;
+}
+
+} // namespace wave
+
+int main(int argc, char** argv) {
+    if (argc < 2)
+        return wave::usage();
+
+    std::string command = argv[1];
+    if (command == "parse") {
+        bool arena_stats = false;
+        int arg = 2;
+        if (arg < argc && std::string(argv[arg]) == "--arena-stats") {
+            arena_stats = true;
+            arg++;
+        }
+        if (arg == argc - 1)
+            return wave::cmd_parse(argv[arg], arena_stats);
+    }
+    if (command == "build" && argc > 2)
+        return wave::cmd_build(argc - 2, argv + 2);
+    if (command == "run" || command == "disasm" || command == "emit-obj") {
+        wave::ProfileFlags flags;
+        std::vector<std::string> rest;
+        for (int i = 2; i < argc; i++) {
+            std::string arg = argv[i];
+            if (arg.rfind("--profile", 0) == 0) {
+                if (!wave::parse_profile_flag(arg, flags))
+                    return 1;
+            } else {
+                rest.push_back(arg);
+            }
+        }
+        if (command == "run" && rest.size() == 2 &&
+            rest[0] == "--snapshot")
+            return wave::cmd_run_snapshot(rest[1]);
+        if (command == "run" && rest.size() == 2 && rest[0] == "--hot")
+            return wave::cmd_run_hot(rest[1]);
+        if (command == "run" && rest.size() == 2 && rest[0] == "--sample")
+            return wave::cmd_run_sample(rest[1]);
+        if (command == "run" && rest.size() == 1)
+            return wave::cmd_run(flags, rest[0]);
+        if (command == "disasm" && rest.size() == 1)
+            return wave::cmd_disasm(flags, rest[0]);
+        if (command == "emit-obj" && rest.size() == 2)
+            return wave::cmd_emit_obj(flags, rest[0], rest[1]);
+        return wave::usage();
+    }
+    if (command == "lsp" && argc == 2)
+        return wave::run_lsp_server(stdin, stdout);
+    if (command == "snapshot" && argc == 4)
+        return wave::cmd_snapshot(argv[2], argv[3]);
+    if (command == "emit-mod" && argc == 4)
+        return wave::cmd_emit_mod(argv[2], argv[3]);
+    if (command == "modinfo" && argc == 3)
+        return wave::cmd_modinfo(argv[2]);
+    return wave::usage();
+}
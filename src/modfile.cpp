@@ -0,0 +1,143 @@
+#include "modfile.h"
+
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace wave {
+
+std::string write_module_bytes(const UnitSummary& summary) {
+    std::vector<ModFun> funs;
+    std::vector<ModParam> params;
+    std::string strings;
+
+    auto add_string = [&](std::string_view text) {
+        ModString str{(uint32_t)strings.size(), (uint32_t)text.size()};
+        strings.append(text.data(), text.size());
+        return str;
+    };
+
+    for (const FunSig& sig : summary.functions) {
+        ModFun fun;
+        fun.name = add_string(sym_text(sig.name));
+        fun.param_index = (uint32_t)params.size();
+        fun.param_count = (uint32_t)sig.params.size();
+        for (const auto& [name, type] : sig.params) {
+            ModParam param;
+            param.name = add_string(sym_text(name));
+            param.type_name = add_string(sym_text(type));
+            params.push_back(param);
+        }
+        funs.push_back(fun);
+    }
+
+    ModHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.magic = kModMagic;
+    header.version = kModVersion;
+    header.fun_count = (uint32_t)funs.size();
+    header.fun_table_off = sizeof(ModHeader);
+    header.param_table_off =
+        header.fun_table_off + (uint32_t)(funs.size() * sizeof(ModFun));
+    header.strings_off =
+        header.param_table_off + (uint32_t)(params.size() * sizeof(ModParam));
+    header.strings_len = (uint32_t)strings.size();
+
+    std::string bytes;
+    bytes.reserve(header.strings_off + strings.size());
+    bytes.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    bytes.append(reinterpret_cast<const char*>(funs.data()),
+                 funs.size() * sizeof(ModFun));
+    bytes.append(reinterpret_cast<const char*>(params.data()),
+                 params.size() * sizeof(ModParam));
+    bytes += strings;
+    return bytes;
+}
+
+MappedModule::MappedModule(MappedModule&& other) noexcept
+    : base_(std::exchange(other.base_, nullptr)),
+      size_(std::exchange(other.size_, 0)) {}
+
+MappedModule& MappedModule::operator=(MappedModule&& other) noexcept {
+    if (this != &other) {
+        close();
+        base_ = std::exchange(other.base_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+    }
+    return *this;
+}
+
+MappedModule::~MappedModule() {
+    close();
+}
+
+void MappedModule::close() {
+    if (base_) {
+        ::munmap(const_cast<char*>(base_), size_);
+        base_ = nullptr;
+        size_ = 0;
+    }
+}
+
+bool MappedModule::open(const std::string& path) {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(ModHeader)) {
+        ::close(fd);
+        return false;
+    }
+    void* mapping = ::mmap(nullptr, (size_t)st.st_size, PROT_READ,
+                           MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED)
+        return false;
+    base_ = static_cast<const char*>(mapping);
+    size_ = (size_t)st.st_size;
+
+    // Validate before anyone indexes through the tables.
+    const ModHeader& hdr = header();
+    uint64_t fun_end =
+        (uint64_t)hdr.fun_table_off + (uint64_t)hdr.fun_count * sizeof(ModFun);
+    uint64_t str_end = (uint64_t)hdr.strings_off + hdr.strings_len;
+    if (hdr.magic != kModMagic || hdr.version != kModVersion ||
+        fun_end > size_ || hdr.param_table_off < fun_end ||
+        hdr.strings_off < hdr.param_table_off || str_end > size_) {
+        close();
+        return false;
+    }
+    // Every record, too: fun(), param() and string() index the mapping
+    // unchecked, so a truncated or corrupt file has to fail here rather
+    // than read out of bounds later.
+    uint64_t param_max =
+        (hdr.strings_off - hdr.param_table_off) / sizeof(ModParam);
+    auto string_ok = [&](ModString str) {
+        return (uint64_t)str.off + str.len <= hdr.strings_len;
+    };
+    for (uint32_t f = 0; f < hdr.fun_count; f++) {
+        const ModFun& record = fun(f);
+        if ((uint64_t)record.param_index + record.param_count > param_max ||
+            !string_ok(record.name)) {
+            close();
+            return false;
+        }
+        for (uint32_t p = 0; p < record.param_count; p++) {
+            const ModParam& param_record = param(record, p);
+            if (!string_ok(param_record.name) ||
+                !string_ok(param_record.type_name)) {
+                close();
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace wave
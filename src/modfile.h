@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "cache.h"
+
+namespace wave {
+
+// Binary module format (.wvm) for compiled Wave interfaces.
+//
+// The file is position-independent: every reference is a byte offset from
+// the start of the file, there are no pointers and no fixup pass, and all
+// records are fixed-width little-endian structs. A consumer maps the file
+// and reads entries in place; importing a large module costs one mmap plus
+// page faults for the entries actually touched.
+//
+// Layout:
+//   ModHeader
+//   ModFun[fun_count]          (at header.fun_table_off)
+//   ModParam[...]              (at header.param_table_off)
+//   string bytes               (at header.strings_off)
+
+constexpr uint32_t kModMagic = 0x314d5657;   // "WVM1"
+constexpr uint32_t kModVersion = 1;
+
+struct ModHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t fun_count;
+    uint32_t fun_table_off;
+    uint32_t param_table_off;
+    uint32_t strings_off;
+    uint32_t strings_len;
+    uint32_t reserved;
+};
+
+struct ModString {
+    uint32_t off; // into the string-bytes section
+    uint32_t len;
+};
+
+struct ModParam {
+    ModString name;
+    ModString type_name;
+};
+
+struct ModFun {
+    ModString name;
+    uint32_t param_index; // first ModParam in the param table
+    uint32_t param_count;
+};
+
+static_assert(sizeof(ModHeader) == 32, "mapped layout is ABI");
+static_assert(sizeof(ModFun) == 16, "mapped layout is ABI");
+static_assert(sizeof(ModParam) == 16, "mapped layout is ABI");
+
+// Serializes a unit's exported signatures into the .wvm byte layout.
+std::string write_module_bytes(const UnitSummary& summary);
+
+// A .wvm file mapped read-only into the process. Accessors return views
+// directly into the mapping; nothing is copied or deserialized up front.
+class MappedModule {
+public:
+    MappedModule() = default;
+    MappedModule(MappedModule&& other) noexcept;
+    MappedModule& operator=(MappedModule&& other) noexcept;
+    MappedModule(const MappedModule&) = delete;
+    MappedModule& operator=(const MappedModule&) = delete;
+    ~MappedModule();
+
+    // Maps and validates `path`; returns false (and stays invalid) on a
+    // missing, truncated or wrong-version file.
+    bool open(const std::string& path);
+    bool valid() const { return base_ != nullptr; }
+
+    uint32_t fun_count() const { return header().fun_count; }
+    const ModFun& fun(uint32_t i) const {
+        return reinterpret_cast<const ModFun*>(base_ +
+                                               header().fun_table_off)[i];
+    }
+    const ModParam& param(const ModFun& fun, uint32_t i) const {
+        return reinterpret_cast<const ModParam*>(
+            base_ + header().param_table_off)[fun.param_index + i];
+    }
+    std::string_view string(ModString str) const {
+        return {base_ + header().strings_off + str.off, str.len};
+    }
+
+private:
+    const ModHeader& header() const {
+        return *reinterpret_cast<const ModHeader*>(base_);
+    }
+    void close();
+
+    const char* base_ = nullptr;
+    size_t size_ = 0;
+};
+
+} // namespace wave
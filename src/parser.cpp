@@ -0,0 +1,360 @@
+#include "parser.h"
+
+#include <cstdio>
+
+#include "diag.h"
+
+namespace wave {
+
+void Parser::parse_module() {
+    std::vector<FunDecl*> functions;
+    std::vector<StructDecl*> structs;
+    while (peek().kind != TokenKind::Eof) {
+        if (peek().kind == TokenKind::KwStruct)
+            structs.push_back(parse_struct_decl());
+        else if (peek().kind == TokenKind::KwFun ||
+                 peek().kind == TokenKind::KwAsync)
+            functions.push_back(parse_fun_decl());
+        else
+            fail(peek(), "expected 'fun' or 'struct' at top level");
+    }
+    module_.functions = module_.arena.copy_span(functions);
+    module_.structs = module_.arena.copy_span(structs);
+}
+
+Token Parser::take() {
+    Token tok = tokens_[pos_];
+    if (tok.kind != TokenKind::Eof)
+        pos_++;
+    return tok;
+}
+
+Token Parser::expect(TokenKind kind) {
+    if (peek().kind != kind)
+        fail(peek(), std::string("expected ") + token_kind_name(kind) +
+                         ", found " + token_kind_name(peek().kind));
+    return take();
+}
+
+bool Parser::accept(TokenKind kind) {
+    if (peek().kind != kind)
+        return false;
+    take();
+    return true;
+}
+
+FunDecl* Parser::parse_fun_decl() {
+    bool is_async = accept(TokenKind::KwAsync);
+    Token fun_tok = expect(TokenKind::KwFun);
+    FunDecl* fun = module_.make<FunDecl>(fun_tok.line, fun_tok.col);
+    fun->is_async = is_async;
+    fun->name = expect(TokenKind::Ident).sym;
+
+    if (accept(TokenKind::LBracket)) {
+        std::vector<Symbol> type_params;
+        while (peek().kind != TokenKind::RBracket) {
+            type_params.push_back(expect(TokenKind::Ident).sym);
+            if (!accept(TokenKind::Comma))
+                break;
+        }
+        expect(TokenKind::RBracket);
+        fun->type_params = module_.arena.copy_span(type_params);
+    }
+
+    expect(TokenKind::LParen);
+    fun->params = parse_param_list(TokenKind::RParen);
+    expect(TokenKind::RParen);
+
+    expect(TokenKind::LBrace);
+    std::vector<Stmt*> body;
+    while (peek().kind != TokenKind::RBrace)
+        body.push_back(parse_stmt());
+    expect(TokenKind::RBrace);
+    fun->body = module_.arena.copy_span(body);
+    return fun;
+}
+
+StructDecl* Parser::parse_struct_decl() {
+    Token struct_tok = expect(TokenKind::KwStruct);
+    StructDecl* decl =
+        module_.make<StructDecl>(struct_tok.line, struct_tok.col);
+    decl->name = expect(TokenKind::Ident).sym;
+    expect(TokenKind::LBrace);
+    decl->fields = parse_param_list(TokenKind::RBrace);
+    expect(TokenKind::RBrace);
+    return decl;
+}
+
+// `name :type` pairs up to (not consuming) `end`; trailing comma allowed.
+Span<Param> Parser::parse_param_list(TokenKind end) {
+    std::vector<Param> params;
+    while (peek().kind != end) {
+        Param param;
+        param.name = expect(TokenKind::Ident).sym;
+        expect(TokenKind::Colon);
+        param.type_name = expect(TokenKind::Ident).sym;
+        params.push_back(param);
+        if (!accept(TokenKind::Comma))
+            break;
+    }
+    return module_.arena.copy_span(params);
+}
+
+Stmt* Parser::parse_stmt() {
+    // Attributes prefix the binding they modify; `@soa` is the only one.
+    bool is_soa = false;
+    if (accept(TokenKind::At)) {
+        Token attr = expect(TokenKind::Ident);
+        if (sym_text(attr.sym) != "soa")
+            fail(attr, "unknown attribute '@" +
+                           std::string(sym_text(attr.sym)) + "'");
+        if (peek().kind != TokenKind::KwVar &&
+            peek().kind != TokenKind::KwCount)
+            fail(peek(), "'@soa' must precede a binding");
+        is_soa = true;
+    }
+
+    if (peek().kind == TokenKind::KwVar || peek().kind == TokenKind::KwCount) {
+        Token intro = take();
+        VarDeclStmt* decl =
+            module_.make<VarDeclStmt>(intro.line, intro.col);
+        decl->is_count = intro.kind == TokenKind::KwCount;
+        decl->is_soa = is_soa;
+        decl->name = expect(TokenKind::Ident).sym;
+        if (accept(TokenKind::Colon))
+            decl->type_name = expect(TokenKind::Ident).sym;
+        expect(TokenKind::Equal);
+        decl->init = parse_expr();
+        accept(TokenKind::Semicolon);
+        return decl;
+    }
+
+    if (peek().kind == TokenKind::KwSpawn) {
+        Token intro = take();
+        SpawnStmt* stmt = module_.make<SpawnStmt>(intro.line, intro.col);
+        Expr* expr = parse_expr();
+        if (expr->kind != ExprKind::Call)
+            fail(intro, "'spawn' expects a function call");
+        stmt->call = static_cast<CallExpr*>(expr);
+        accept(TokenKind::Semicolon);
+        return stmt;
+    }
+
+    if (peek().kind == TokenKind::KwEach) {
+        Token intro = take();
+        EachStmt* stmt = module_.make<EachStmt>(intro.line, intro.col);
+        stmt->var = expect(TokenKind::Ident).sym;
+        expect(TokenKind::KwIn);
+        stmt->seq = parse_expr();
+        expect(TokenKind::LBrace);
+        std::vector<Stmt*> body;
+        while (peek().kind != TokenKind::RBrace)
+            body.push_back(parse_stmt());
+        expect(TokenKind::RBrace);
+        stmt->body = module_.arena.copy_span(body);
+        return stmt;
+    }
+
+    ExprStmt* stmt = module_.make<ExprStmt>(peek().line, peek().col);
+    stmt->expr = parse_expr();
+    accept(TokenKind::Semicolon);
+    return stmt;
+}
+
+Expr* Parser::parse_expr() {
+    Expr* expr = parse_primary();
+    while (accept(TokenKind::Dot)) {
+        Token field = expect(TokenKind::Ident);
+        FieldExpr* access = module_.make<FieldExpr>(field.line, field.col);
+        access->base = expr;
+        access->field = field.sym;
+        expr = access;
+    }
+    return expr;
+}
+
+Expr* Parser::parse_primary() {
+    Token tok = take();
+    switch (tok.kind) {
+    case TokenKind::Int: {
+        IntLitExpr* lit = module_.make<IntLitExpr>(tok.line, tok.col);
+        lit->value = tok.int_value;
+        return lit;
+    }
+    case TokenKind::Float: {
+        FloatLitExpr* lit = module_.make<FloatLitExpr>(tok.line, tok.col);
+        lit->value = tok.float_value;
+        return lit;
+    }
+    case TokenKind::Str: {
+        StrLitExpr* lit = module_.make<StrLitExpr>(tok.line, tok.col);
+        lit->value = tok.sym;
+        return lit;
+    }
+    case TokenKind::Ident: {
+        if (peek().kind == TokenKind::LParen) {
+            CallExpr* call = module_.make<CallExpr>(tok.line, tok.col);
+            call->callee = tok.sym;
+            take(); // '('
+            std::vector<Expr*> args;
+            if (peek().kind != TokenKind::RParen) {
+                do {
+                    args.push_back(parse_expr());
+                } while (accept(TokenKind::Comma));
+            }
+            expect(TokenKind::RParen);
+            call->args = module_.arena.copy_span(args);
+            return call;
+        }
+        IdentExpr* ident = module_.make<IdentExpr>(tok.line, tok.col);
+        ident->name = tok.sym;
+        return ident;
+    }
+    case TokenKind::LBracket: {
+        ArrayLitExpr* array = module_.make<ArrayLitExpr>(tok.line, tok.col);
+        std::vector<Expr*> elems;
+        while (peek().kind != TokenKind::RBracket) {
+            elems.push_back(parse_expr());
+            if (!accept(TokenKind::Comma)) // trailing comma allowed
+                break;
+        }
+        expect(TokenKind::RBracket);
+        array->elems = module_.arena.copy_span(elems);
+        return array;
+    }
+    default:
+        fail(tok, std::string("expected expression, found ") +
+                      token_kind_name(tok.kind));
+    }
+}
+
+void Parser::fail(const Token& at, const std::string& msg) const {
+    error(file_name_, at.line, at.col, msg);
+    throw CompileError();
+}
+
+#define SV(view) (int)(view).size(), (view).data()
+
+static void dump_expr(const Expr* expr, int indent) {
+    std::printf("%*s", indent, "");
+    switch (expr->kind) {
+    case ExprKind::IntLit:
+        std::printf("IntLit %lld\n",
+                    (long long)static_cast<const IntLitExpr*>(expr)->value);
+        break;
+    case ExprKind::FloatLit:
+        std::printf("FloatLit %g\n",
+                    (double)static_cast<const FloatLitExpr*>(expr)->value);
+        break;
+    case ExprKind::StrLit:
+        std::printf("StrLit \"%.*s\"\n",
+                    SV(sym_text(static_cast<const StrLitExpr*>(expr)->value)));
+        break;
+    case ExprKind::Ident:
+        std::printf("Ident %.*s\n",
+                    SV(sym_text(static_cast<const IdentExpr*>(expr)->name)));
+        break;
+    case ExprKind::Call: {
+        const auto* call = static_cast<const CallExpr*>(expr);
+        std::printf("Call %.*s\n", SV(sym_text(call->callee)));
+        for (const Expr* arg : call->args)
+            dump_expr(arg, indent + 2);
+        break;
+    }
+    case ExprKind::Field: {
+        const auto* access = static_cast<const FieldExpr*>(expr);
+        std::printf("Field .%.*s\n", SV(sym_text(access->field)));
+        dump_expr(access->base, indent + 2);
+        break;
+    }
+    case ExprKind::ArrayLit: {
+        const auto* array = static_cast<const ArrayLitExpr*>(expr);
+        std::printf("ArrayLit [%u]\n", array->elems.size());
+        for (const Expr* elem : array->elems)
+            dump_expr(elem, indent + 2);
+        break;
+    }
+    case ExprKind::Print: {
+        const auto* print = static_cast<const PrintExpr*>(expr);
+        std::printf("Print\n");
+        for (const PrintOp& op : print->ops) {
+            if (op.kind == PrintOpKind::WriteLit) {
+                std::printf("%*sWriteLit \"%.*s\"\n", indent + 2, "",
+                            SV(sym_text(op.literal)));
+            } else {
+                const char* kind = "WriteStr";
+                if (op.kind == PrintOpKind::WriteInt)
+                    kind = "WriteInt";
+                else if (op.kind == PrintOpKind::WriteFloat)
+                    kind = "WriteFloat";
+                else if (op.kind == PrintOpKind::WriteVec)
+                    kind = "WriteVec";
+                std::printf("%*s%s\n", indent + 2, "", kind);
+                dump_expr(op.arg, indent + 4);
+            }
+        }
+        break;
+    }
+    }
+}
+
+static void dump_stmt(const Stmt* stmt, int indent) {
+    if (stmt->kind == StmtKind::VarDecl) {
+        const auto* decl = static_cast<const VarDeclStmt*>(stmt);
+        std::printf("%*s%s %.*s%s%.*s =\n", indent, "",
+                    decl->is_count ? "Count" : "Var",
+                    SV(sym_text(decl->name)),
+                    decl->type_name == kNoSymbol ? "" : " :",
+                    decl->type_name == kNoSymbol
+                        ? 0
+                        : (int)sym_text(decl->type_name).size(),
+                    decl->type_name == kNoSymbol
+                        ? ""
+                        : sym_text(decl->type_name).data());
+        dump_expr(decl->init, indent + 2);
+    } else if (stmt->kind == StmtKind::Spawn) {
+        std::printf("%*sSpawn\n", indent, "");
+        dump_expr(static_cast<const SpawnStmt*>(stmt)->call, indent + 2);
+    } else if (stmt->kind == StmtKind::Each) {
+        const auto* each = static_cast<const EachStmt*>(stmt);
+        std::printf("%*sEach %.*s\n", indent, "",
+                    SV(sym_text(each->var)));
+        dump_expr(each->seq, indent + 2);
+        for (const Stmt* inner : each->body)
+            dump_stmt(inner, indent + 2);
+    } else {
+        dump_expr(static_cast<const ExprStmt*>(stmt)->expr, indent);
+    }
+}
+
+void dump_module(const Module& module) {
+    std::printf("Module %.*s\n", SV(module.file_name));
+    for (const StructDecl* decl : module.structs) {
+        std::printf("  Struct %.*s\n", SV(sym_text(decl->name)));
+        for (const Param& field : decl->fields)
+            std::printf("    %.*s :%.*s\n", SV(sym_text(field.name)),
+                        SV(sym_text(field.type_name)));
+    }
+    for (const FunDecl* fun : module.functions) {
+        std::printf("  %sFun %.*s", fun->is_async ? "Async" : "",
+                    SV(sym_text(fun->name)));
+        if (fun->type_params.size()) {
+            std::printf("[");
+            for (uint32_t i = 0; i < fun->type_params.size(); i++)
+                std::printf("%s%.*s", i ? ", " : "",
+                            SV(sym_text(fun->type_params[i])));
+            std::printf("]");
+        }
+        std::printf("(");
+        for (uint32_t i = 0; i < fun->params.size(); i++)
+            std::printf("%s%.*s :%.*s", i ? ", " : "", SV(sym_text(fun->params[i].name)),
+                        SV(sym_text(fun->params[i].type_name)));
+        std::printf(")\n");
+        for (const Stmt* stmt : fun->body)
+            dump_stmt(stmt, 4);
+    }
+}
+
+#undef SV
+
+} // namespace wave
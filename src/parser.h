@@ -0,0 +1,58 @@
+#pragma once
+
+#include <string_view>
+#include <vector>
+
+#include "ast.h"
+#include "token.h"
+
+namespace wave {
+
+// Recursive-descent parser for the Wave grammar:
+//
+//   module      := (fun_decl | struct_decl)*
+//   fun_decl    := 'async'? 'fun' IDENT ('[' IDENT (',' IDENT)* ']')?
+//                  '(' params? ')' '{' stmt* '}'
+//   struct_decl := 'struct' IDENT '{' params? '}'
+//   params      := param (',' param)*
+//   param       := IDENT ':' IDENT
+//   stmt        := '@soa'? ('var' | 'count') IDENT (':' IDENT)? '=' expr ';'?
+//                | 'spawn' call ';'?
+//                | 'each' IDENT 'in' expr '{' stmt* '}'
+//                | expr ';'?
+//   expr        := (INT | FLOAT | STR | IDENT ('(' args? ')')?
+//                  | '[' expr (',' expr)* ']') ('.' IDENT)*
+//
+// Statement semicolons are accepted but optional, matching the sources in
+// example/.
+class Parser {
+public:
+    Parser(std::string_view file_name, std::vector<Token> tokens,
+           Module& module)
+        : file_name_(file_name), tokens_(std::move(tokens)), module_(module) {}
+
+    // Parses the whole token stream into `module`; throws CompileError on
+    // the first syntax error.
+    void parse_module();
+
+private:
+    const Token& peek() const { return tokens_[pos_]; }
+    Token take();
+    Token expect(TokenKind kind);
+    bool accept(TokenKind kind);
+    [[noreturn]] void fail(const Token& at, const std::string& msg) const;
+
+    FunDecl* parse_fun_decl();
+    StructDecl* parse_struct_decl();
+    Span<Param> parse_param_list(TokenKind end);
+    Stmt* parse_stmt();
+    Expr* parse_expr();
+    Expr* parse_primary();
+
+    std::string_view file_name_;
+    std::vector<Token> tokens_;
+    size_t pos_ = 0;
+    Module& module_;
+};
+
+} // namespace wave
@@ -0,0 +1,35 @@
+#include "profile.h"
+
+#include <fstream>
+#include <sstream>
+
+namespace wave {
+
+bool ProfileData::load(const std::string& path) {
+    std::ifstream in(path);
+    if (!in)
+        return false;
+    std::string header;
+    if (!std::getline(in, header) || header != "wave-profile v1")
+        return false;
+    std::string name;
+    uint64_t count;
+    while (in >> name >> count)
+        record(intern(name), count);
+    return true;
+}
+
+bool ProfileData::save(const std::string& path) const {
+    std::ofstream out(path, std::ios::trunc);
+    if (!out)
+        return false;
+    out << "wave-profile v1\n";
+    for (const auto& [fun, count] : call_counts) {
+        std::string_view name = sym_text(fun);
+        out.write(name.data(), (std::streamsize)name.size());
+        out << ' ' << count << '\n';
+    }
+    return (bool)out;
+}
+
+} // namespace wave
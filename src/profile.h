@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+#include "interner.h"
+
+namespace wave {
+
+// Execution profile collected by an instrumented run and fed back into
+// compilation. Counts are per function; game workloads are skewed enough
+// that function-level heat already separates the 5% of script code that
+// matters from the rest.
+struct ProfileData {
+    std::unordered_map<Symbol, uint64_t> call_counts;
+    uint64_t total_calls = 0;
+
+    void record(Symbol fun, uint64_t count) {
+        call_counts[fun] += count;
+        total_calls += count;
+    }
+
+    uint64_t count_of(Symbol fun) const {
+        auto it = call_counts.find(fun);
+        return it != call_counts.end() ? it->second : 0;
+    }
+
+    // A function is hot when it carries at least 2% of all recorded
+    // calls; the inliner widens its budget for hot callees and refuses
+    // cold ones.
+    bool is_hot(Symbol fun) const {
+        return total_calls > 0 && count_of(fun) * 50 >= total_calls;
+    }
+    bool is_cold(Symbol fun) const {
+        return total_calls > 0 && count_of(fun) == 0;
+    }
+
+    // Text format, one "name count" line per function. Returns false on
+    // a missing or malformed file.
+    bool load(const std::string& path);
+    bool save(const std::string& path) const;
+};
+
+// Default profile path for --profile-generate / --profile-use.
+constexpr const char* kDefaultProfilePath = "wave.profdata";
+
+} // namespace wave
@@ -0,0 +1,62 @@
+#include "reactor.h"
+
+#include <cerrno>
+#include <thread>
+
+#include <sys/epoll.h>
+
+namespace wave {
+
+Reactor& Reactor::global() {
+    // Leaked like the scheduler: the poll thread runs for the process
+    // lifetime, and static destruction would race it.
+    static Reactor* reactor = new Reactor();
+    return *reactor;
+}
+
+Reactor::Reactor() {
+    epoll_fd_ = ::epoll_create1(0);
+    std::thread([this] { run(); }).detach();
+}
+
+bool Reactor::watch(int fd, bool writable, const Task& task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        armed_[fd] = task;
+    }
+    struct epoll_event ev;
+    ev.events = (writable ? EPOLLOUT : EPOLLIN) | EPOLLONESHOT;
+    ev.data.fd = fd;
+    if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) == 0)
+        return true;
+    // Re-arming a descriptor a previous one-shot left registered.
+    if (errno == EEXIST &&
+        ::epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &ev) == 0)
+        return true;
+    std::lock_guard<std::mutex> lock(mutex_);
+    armed_.erase(fd);
+    return false;
+}
+
+void Reactor::run() {
+    struct epoll_event events[64];
+    for (;;) {
+        int n = ::epoll_wait(epoll_fd_, events, 64, -1);
+        for (int i = 0; i < n; i++) {
+            Task task;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                auto it = armed_.find(events[i].data.fd);
+                if (it == armed_.end())
+                    continue;
+                task = it->second;
+                armed_.erase(it);
+            }
+            // Hand the continuation to the pool; the poll thread goes
+            // straight back to waiting.
+            TaskScheduler::global().spawn(task);
+        }
+    }
+}
+
+} // namespace wave
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <mutex>
+#include <unordered_map>
+
+#include "task.h"
+
+namespace wave {
+
+// Readiness reactor behind the task scheduler.
+//
+// Server workloads wait on thousands of descriptors at once; parking a
+// pool worker per descriptor would drain the scheduler dry. Instead one
+// dedicated thread blocks in epoll_wait for the whole process, and a
+// descriptor becoming ready turns into an ordinary bounded Task pushed
+// onto the work-stealing pool — the continuation runs wherever a worker
+// picks it up, never on the poll thread itself. An armed continuation
+// is the same inline-argument Task object `spawn` uses, so waiting on
+// I/O allocates nothing.
+//
+// Registration is one-shot: a readiness event disarms the descriptor,
+// and the continuation re-arms it if it wants more. That is the shape
+// an `async fun` resumption needs — each await re-arms with the next
+// state — and it sidesteps level-triggered storms on descriptors the
+// pool has not gotten to yet.
+class Reactor {
+public:
+    // The process-wide reactor; its poll thread starts on first use and
+    // lives for the rest of the process.
+    static Reactor& global();
+
+    // Arms `task` to run on the pool when `fd` becomes readable (or
+    // writable). One-shot: the watch is consumed by the first event.
+    // The task's group must already count it, exactly as with
+    // TaskScheduler::spawn. Returns false if `fd` cannot be polled.
+    bool watch(int fd, bool writable, const Task& task);
+
+private:
+    Reactor();
+    void run();
+
+    int epoll_fd_ = -1;
+    std::mutex mutex_;
+    std::unordered_map<int, Task> armed_;
+};
+
+} // namespace wave
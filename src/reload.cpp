@@ -0,0 +1,99 @@
+#include "reload.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#include <sys/stat.h>
+
+#include "diag.h"
+#include "lexer.h"
+#include "parser.h"
+#include "sema.h"
+
+namespace wave {
+
+namespace {
+
+// Splices a freshly lowered program into the live function table. The
+// fresh program's Call/Spawn operands index its own table, so every
+// fresh function is given a live slot first (appending the new ones)
+// and operands are remapped as bodies are copied over. Existing
+// functions keep their index — live identity never moves.
+void patch(BcProgram& live, BcProgram&& fresh) {
+    std::vector<uint16_t> live_index(fresh.functions.size());
+    for (size_t f = 0; f < fresh.functions.size(); f++) {
+        BcFunction& fn = fresh.functions[f];
+        auto it = live.by_name.find(fn.name);
+        if (it == live.by_name.end()) {
+            uint16_t index = (uint16_t)live.functions.size();
+            live.functions.emplace_back();
+            live.functions[index].name = fn.name;
+            it = live.by_name.emplace(fn.name, index).first;
+        }
+        live_index[f] = it->second;
+    }
+    for (size_t f = 0; f < fresh.functions.size(); f++) {
+        BcFunction& fn = fresh.functions[f];
+        for (Insn& insn : fn.code)
+            if (insn.op == Op::Call || insn.op == Op::Spawn)
+                insn.c = live_index[insn.c];
+        BcFunction& dst = live.functions[live_index[f]];
+        dst.num_params = fn.num_params;
+        dst.num_regs = fn.num_regs;
+        dst.code = std::move(fn.code);
+        dst.constants = std::move(fn.constants);
+    }
+    live.main_index = live_index[fresh.main_index];
+}
+
+// Nanosecond mtime: editors save faster than once a second, and a
+// whole-second stamp would miss the second edit.
+uint64_t file_mtime(const std::string& path) {
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0)
+        return 0;
+    return (uint64_t)st.st_mtim.tv_sec * 1000000000 +
+           (uint64_t)st.st_mtim.tv_nsec;
+}
+
+} // namespace
+
+HotReloader::HotReloader(std::string path)
+    : path_(std::move(path)), mtime_ns_(file_mtime(path_)) {}
+
+bool HotReloader::poll(BcProgram& live) {
+    uint64_t mtime = file_mtime(path_);
+    if (mtime == mtime_ns_)
+        return false;
+    // Record before compiling: a broken edit should not recompile
+    // every frame until the next keystroke.
+    mtime_ns_ = mtime;
+
+    std::ifstream in(path_, std::ios::binary);
+    if (!in)
+        return false;
+    std::ostringstream buf;
+    buf << in.rdbuf();
+    std::string source = buf.str();
+
+    Module module;
+    module.file_name = module.arena.copy_string(path_);
+    try {
+        Lexer lexer(path_, source);
+        Parser parser(path_, lexer.lex_all(), module);
+        parser.parse_module();
+        analyze_module(module);
+        patch(live, lower_module(module));
+    } catch (const CompileError&) {
+        std::fprintf(stderr, "wave: reload failed; keeping the running "
+                             "version of '%s'\n",
+                     path_.c_str());
+        return false;
+    }
+    std::fprintf(stderr, "wave: reloaded '%s'\n", path_.c_str());
+    return true;
+}
+
+} // namespace wave
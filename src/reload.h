@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "bytecode.h"
+
+namespace wave {
+
+// In-process hot reload for the bytecode tier.
+//
+// A designer tweaking a value should see it in the running game in
+// milliseconds, not pay a restart plus asset load plus replaying state.
+// The reloader watches one source file; when its modification time
+// changes it reruns the front end (the same parse/analyze/lower
+// pipeline `wave run` uses) and patches the recompiled bodies into the
+// live program's function table — code, constants and register counts
+// swap, indices and identity stay. Functions added by the edit are
+// appended; functions deleted by it simply become unreachable.
+//
+// Patching is only safe at a frame boundary: poll() must be called
+// when no interpreter activation is running. Spawned tasks cannot leak
+// past that point — they join structurally before their spawning
+// function returns — so between two run_program calls the table has no
+// reader. String constants borrow interner storage, which is
+// append-only for the process lifetime, so values captured from the old
+// version stay valid after the swap.
+class HotReloader {
+public:
+    explicit HotReloader(std::string path);
+
+    // Recompiles and patches `live` if the file changed since the last
+    // call. Returns true when a new version was swapped in; on a
+    // compile error the diagnostics print and the old version keeps
+    // running.
+    bool poll(BcProgram& live);
+
+private:
+    std::string path_;
+    uint64_t mtime_ns_ = 0;
+};
+
+} // namespace wave
@@ -0,0 +1,263 @@
+#include "wave_rt.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+
+#include <unistd.h>
+
+/* -- buffered output ---------------------------------------------------- */
+
+/* Each thread accumulates into its own buffer and only takes the
+ * writer lock to drain it, so the lock is contended once per ~16KB of
+ * output instead of once per print. The destructor flushes whatever a
+ * thread leaves behind when it exits (the main thread included). */
+namespace {
+
+constexpr size_t kOutBufSize = 16 * 1024;
+
+std::mutex g_writer_mutex;
+
+struct OutBuf {
+    char data[kOutBufSize];
+    size_t used = 0;
+
+    ~OutBuf() { flush(); }
+
+    void flush() {
+        if (!used)
+            return;
+        std::lock_guard<std::mutex> lock(g_writer_mutex);
+        size_t done = 0;
+        while (done < used) {
+            ssize_t n = ::write(1, data + done, used - done);
+            if (n <= 0)
+                break;
+            done += (size_t)n;
+        }
+        used = 0;
+    }
+
+    void append(const char* bytes, size_t len) {
+        if (len > kOutBufSize - used)
+            flush();
+        if (len > kOutBufSize) { /* oversized payload: write through */
+            std::lock_guard<std::mutex> lock(g_writer_mutex);
+            size_t done = 0;
+            while (done < len) {
+                ssize_t n = ::write(1, bytes + done, len - done);
+                if (n <= 0)
+                    break;
+                done += (size_t)n;
+            }
+            return;
+        }
+        std::memcpy(data + used, bytes, len);
+        used += len;
+    }
+};
+
+thread_local OutBuf g_out;
+
+} // namespace
+
+extern "C" {
+
+void wave_rt_write_lit(const char* data, size_t len) {
+    g_out.append(data, len);
+}
+
+void wave_rt_write_int(int64_t value) {
+    char buf[24];
+    int len = std::snprintf(buf, sizeof(buf), "%lld", (long long)value);
+    g_out.append(buf, (size_t)len);
+}
+
+void wave_rt_write_str(const char* data, size_t len) {
+    g_out.append(data, len);
+}
+
+void wave_rt_write_f32(float value) {
+    char buf[32];
+    int len = std::snprintf(buf, sizeof(buf), "%g", (double)value);
+    g_out.append(buf, (size_t)len);
+}
+
+void wave_rt_write_vec(const float* values, size_t lanes) {
+    g_out.append("(", 1);
+    for (size_t l = 0; l < lanes; l++) {
+        if (l)
+            g_out.append(", ", 2);
+        wave_rt_write_f32(values[l]);
+    }
+    g_out.append(")", 1);
+}
+
+void wave_rt_flush(void) {
+    g_out.flush();
+}
+
+/* -- typed buffers ------------------------------------------------------ */
+
+/* A buffer is a fat descriptor over bytes that already exist; none of
+ * these functions move or touch the payload. Ownership is carried in
+ * the tag so retain/release are safe to call unconditionally — the
+ * borrowed case simply does nothing, mirroring how :str slices never
+ * own their backing bytes. */
+
+WaveRtBuffer wave_rt_buf_borrow(void* data, uint64_t len,
+                                uint32_t elem_size) {
+    WaveRtBuffer buf;
+    buf.data = data;
+    buf.len = len;
+    buf.elem_size = elem_size;
+    buf.owner = WAVE_RT_BUF_BORROWED;
+    return buf;
+}
+
+WaveRtBuffer wave_rt_buf_donate(void* payload, uint64_t len,
+                                uint32_t elem_size) {
+    WaveRtBuffer buf;
+    buf.data = payload;
+    buf.len = len;
+    buf.elem_size = elem_size;
+    buf.owner = WAVE_RT_BUF_DONATED;
+    return buf;
+}
+
+void wave_rt_buf_retain(const WaveRtBuffer* buf) {
+    if (buf->owner == WAVE_RT_BUF_DONATED)
+        wave_rt_retain(buf->data);
+}
+
+void wave_rt_buf_release(const WaveRtBuffer* buf) {
+    if (buf->owner == WAVE_RT_BUF_DONATED)
+        wave_rt_release(buf->data);
+}
+
+WaveRtBuffer wave_rt_buf_slice(const WaveRtBuffer* buf, uint64_t start,
+                               uint64_t len) {
+    if (start > buf->len)
+        start = buf->len;
+    if (len > buf->len - start)
+        len = buf->len - start;
+    WaveRtBuffer view;
+    view.data = (char*)buf->data + start * buf->elem_size;
+    view.len = len;
+    view.elem_size = buf->elem_size;
+    view.owner = WAVE_RT_BUF_BORROWED;
+    return view;
+}
+
+/* -- counted heap blocks ------------------------------------------------ */
+
+/* The count sits in a 16-byte header so the payload keeps the maximal
+ * alignment vector fields need. Counting is atomic so blocks may be
+ * handed between threads; release is the only place a block is freed,
+ * which is what makes destruction deterministic. */
+struct WaveRtBoxHeader {
+    std::atomic<uint32_t> count;
+    uint32_t pad[3];
+};
+
+static WaveRtBoxHeader* box_header(void* payload) {
+    return (WaveRtBoxHeader*)payload - 1;
+}
+
+void* wave_rt_alloc(size_t size) {
+    auto* header =
+        (WaveRtBoxHeader*)std::malloc(sizeof(WaveRtBoxHeader) + size);
+    if (!header)
+        return nullptr;
+    new (&header->count) std::atomic<uint32_t>(1);
+    return header + 1;
+}
+
+void wave_rt_retain(void* payload) {
+    box_header(payload)->count.fetch_add(1, std::memory_order_relaxed);
+}
+
+void wave_rt_release(void* payload) {
+    WaveRtBoxHeader* header = box_header(payload);
+    if (header->count.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        std::free(header);
+}
+
+/* -- region allocators -------------------------------------------------- */
+
+/* Same design as the compiler's AST arena: chunked pointer bumps,
+ * doubling chunk sizes, O(1) reset. Reset keeps the chunk list so a
+ * steady-state frame loop stops hitting malloc entirely. */
+struct WaveRtChunk {
+    WaveRtChunk* next;
+    size_t size;
+    size_t used;
+    size_t pad; /* keeps the payload base 16-aligned */
+    /* payload follows */
+};
+
+/* The payload starts right after the header and allocation sizes are
+ * rounded to 16, so every pointer handed out is 16-aligned exactly when
+ * the header size is a multiple of 16 — vector fields are stored with
+ * movaps and fault on anything less. */
+static_assert(sizeof(WaveRtChunk) % 16 == 0,
+              "region payloads must stay 16-aligned");
+
+struct WaveRtArena {
+    WaveRtChunk* chunks; /* newest first */
+    size_t next_chunk_size;
+};
+
+static const size_t kArenaChunkSize = 64 * 1024;
+
+WaveRtArena* wave_rt_arena_create(void) {
+    auto* arena = (WaveRtArena*)std::malloc(sizeof(WaveRtArena));
+    if (!arena)
+        return nullptr;
+    arena->chunks = nullptr;
+    arena->next_chunk_size = kArenaChunkSize;
+    return arena;
+}
+
+void wave_rt_arena_destroy(WaveRtArena* arena) {
+    WaveRtChunk* chunk = arena->chunks;
+    while (chunk) {
+        WaveRtChunk* next = chunk->next;
+        std::free(chunk);
+        chunk = next;
+    }
+    std::free(arena);
+}
+
+void* wave_rt_arena_alloc(WaveRtArena* arena, size_t size) {
+    size = (size + 15) & ~(size_t)15;
+    WaveRtChunk* chunk = arena->chunks;
+    if (!chunk || chunk->used + size > chunk->size) {
+        size_t chunk_size = arena->next_chunk_size;
+        while (chunk_size < size)
+            chunk_size *= 2;
+        auto* fresh =
+            (WaveRtChunk*)std::malloc(sizeof(WaveRtChunk) + chunk_size);
+        if (!fresh)
+            return nullptr;
+        fresh->next = arena->chunks;
+        fresh->size = chunk_size;
+        fresh->used = 0;
+        arena->chunks = fresh;
+        arena->next_chunk_size = chunk_size * 2;
+        chunk = fresh;
+    }
+    void* out = (char*)(chunk + 1) + chunk->used;
+    chunk->used += size;
+    return out;
+}
+
+void wave_rt_arena_reset(WaveRtArena* arena) {
+    for (WaveRtChunk* chunk = arena->chunks; chunk; chunk = chunk->next)
+        chunk->used = 0;
+}
+
+} // extern "C"
@@ -0,0 +1,131 @@
+/*
+ * Wave runtime interface for AOT-compiled code and embedding engines.
+ *
+ * Calling convention: exported Wave functions use the platform C ABI
+ * (System V on x86-64) under the symbol name `wave_<fun>`, so C++ calls
+ * them directly with no marshalling layer:
+ *
+ *   fun hello(name :str)   ->  void wave_hello(const char* data, size_t len)
+ *   fun main()             ->  void wave_main(void)
+ *
+ * Integer parameters pass as int64_t in one register; string parameters
+ * pass as a (pointer, length) pair in two registers — a borrowed slice,
+ * never an allocation. Compiled Wave code calls back into the helpers
+ * below for I/O; an engine links libwave_rt (or provides its own
+ * implementations of these three symbols) alongside the emitted objects.
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Output path. Writes append to a per-thread buffer; a buffer drains
+ * through one writer as a single write(2) when it fills, when its
+ * thread exits, or on an explicit flush. A hot print loop therefore
+ * costs a bounds check and a memcpy per call — no global mutex, no
+ * syscall — and bytes written by one thread never interleave inside a
+ * flushed batch.
+ */
+
+/* Write a compile-time literal segment. */
+void wave_rt_write_lit(const char* data, size_t len);
+
+/* Write an integer in decimal. */
+void wave_rt_write_int(int64_t value);
+
+/* Write a string slice. */
+void wave_rt_write_str(const char* data, size_t len);
+
+/* Write a float. */
+void wave_rt_write_f32(float value);
+
+/* Write `lanes` floats as "(x, y, ...)". */
+void wave_rt_write_vec(const float* values, size_t lanes);
+
+/* Drain the calling thread's output buffer. Wave code flushes at
+ * program and task exit; an embedding engine should flush before
+ * writing to stdout itself. */
+void wave_rt_flush(void);
+
+/*
+ * Typed buffers (see Docs/Buffers.md). The FFI currency for bulk data:
+ * a pointer, an element count and size, and an ownership tag — never a
+ * copy. An engine hands a vertex blob to Wave by *borrowing* (the
+ * engine keeps ownership and must outlive the call) or by *donating* a
+ * counted block from wave_rt_alloc (ownership transfers; whoever holds
+ * the last reference frees it via release). Either way the payload
+ * bytes are untouched: handing a 100MB asset across the boundary costs
+ * one descriptor, zero bytes of duplication.
+ */
+
+enum WaveRtBufOwner {
+    WAVE_RT_BUF_BORROWED = 0, /* caller owns the bytes; release is a no-op */
+    WAVE_RT_BUF_DONATED = 1,  /* counted block; release may free it */
+};
+
+typedef struct WaveRtBuffer {
+    void* data;
+    uint64_t len;       /* element count */
+    uint32_t elem_size; /* bytes per element */
+    uint32_t owner;     /* WaveRtBufOwner */
+} WaveRtBuffer;
+
+/* Wrap caller-owned bytes. The caller keeps them alive for as long as
+ * the buffer (or any slice of it) is in use. */
+WaveRtBuffer wave_rt_buf_borrow(void* data, uint64_t len, uint32_t elem_size);
+
+/* Transfer a block from wave_rt_alloc into a buffer. The buffer takes
+ * over the block's reference; pair with wave_rt_buf_release. */
+WaveRtBuffer wave_rt_buf_donate(void* payload, uint64_t len,
+                                uint32_t elem_size);
+
+/* Share / drop a donated buffer's backing block (no-ops on borrowed
+ * buffers, so callers need not branch on the tag). */
+void wave_rt_buf_retain(const WaveRtBuffer* buf);
+void wave_rt_buf_release(const WaveRtBuffer* buf);
+
+/* An O(1) borrowed view of `len` elements starting at `start`; bounds
+ * clamp to the source, so a view never leaves its backing data. The
+ * source must outlive the view. */
+WaveRtBuffer wave_rt_buf_slice(const WaveRtBuffer* buf, uint64_t start,
+                               uint64_t len);
+
+/*
+ * Memory management (see Docs/MemoryModel.md). Wave is deterministic
+ * and non-tracing: heap values are owned, shared ones are reference
+ * counted, and per-frame data goes through region allocators. Nothing
+ * here can pause; release frees immediately at count zero and a region
+ * reset is O(1) regardless of how much was allocated from it.
+ */
+
+/* Allocate a counted heap block (count starts at 1). Returns the
+ * payload; the count lives in a header before it. */
+void* wave_rt_alloc(size_t size);
+
+/* Increment the count of a block returned by wave_rt_alloc. */
+void wave_rt_retain(void* payload);
+
+/* Decrement the count; frees the block when it reaches zero. */
+void wave_rt_release(void* payload);
+
+/* Region allocator: pointer-bump allocation, bulk free. */
+typedef struct WaveRtArena WaveRtArena;
+
+WaveRtArena* wave_rt_arena_create(void);
+void wave_rt_arena_destroy(WaveRtArena* arena);
+
+/* Allocate `size` bytes, 16-byte aligned, from the region. */
+void* wave_rt_arena_alloc(WaveRtArena* arena, size_t size);
+
+/* Free everything allocated from the region at once; the region's
+ * memory is retained for reuse. */
+void wave_rt_arena_reset(WaveRtArena* arena);
+
+#ifdef __cplusplus
+}
+#endif
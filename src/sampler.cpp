@@ -0,0 +1,154 @@
+#include "sampler.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace wave {
+
+namespace {
+
+struct ShadowStack {
+    std::mutex mutex;
+    std::vector<Symbol> frames;
+};
+
+thread_local ShadowStack tls_stack;
+
+std::atomic<bool> g_enabled{false};
+
+std::mutex g_registry_mutex;
+std::vector<ShadowStack*> g_stacks;
+
+// Aggregated samples: written by the sampler thread and the frame
+// marker, read by report() after sampling stops. Keyed by the joined
+// stack so identical stacks collapse as they arrive.
+std::mutex g_data_mutex;
+std::map<std::string, uint64_t> g_collapsed;
+uint64_t g_total_samples = 0;
+uint64_t g_frame_index = 0;
+uint64_t g_frame_samples = 0; // in the current frame
+uint64_t g_worst_frame = 0;
+uint64_t g_worst_samples = 0;
+
+void sample_once() {
+    std::lock_guard<std::mutex> registry(g_registry_mutex);
+    for (ShadowStack* stack : g_stacks) {
+        std::string key;
+        {
+            std::lock_guard<std::mutex> lock(stack->mutex);
+            for (Symbol fn : stack->frames) {
+                if (!key.empty())
+                    key += ';';
+                key += sym_text(fn);
+            }
+        }
+        if (key.empty())
+            continue;
+        std::lock_guard<std::mutex> data(g_data_mutex);
+        g_collapsed[key]++;
+        g_total_samples++;
+        g_frame_samples++;
+    }
+}
+
+void sampler_main() {
+    while (g_enabled.load(std::memory_order_acquire)) {
+        sample_once();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+} // namespace
+
+Sampler& Sampler::global() {
+    static Sampler sampler;
+    return sampler;
+}
+
+void Sampler::enable() {
+    g_enabled.store(true, std::memory_order_release);
+    std::thread(sampler_main).detach();
+}
+
+bool Sampler::enabled() const {
+    return g_enabled.load(std::memory_order_relaxed);
+}
+
+void Sampler::attach(Symbol fn) {
+    {
+        std::lock_guard<std::mutex> registry(g_registry_mutex);
+        g_stacks.push_back(&tls_stack);
+    }
+    push(fn);
+}
+
+void Sampler::detach() {
+    {
+        std::lock_guard<std::mutex> lock(tls_stack.mutex);
+        tls_stack.frames.clear();
+    }
+    std::lock_guard<std::mutex> registry(g_registry_mutex);
+    for (size_t i = 0; i < g_stacks.size(); i++) {
+        if (g_stacks[i] == &tls_stack) {
+            g_stacks.erase(g_stacks.begin() + (long)i);
+            break;
+        }
+    }
+}
+
+void Sampler::push(Symbol fn) {
+    std::lock_guard<std::mutex> lock(tls_stack.mutex);
+    tls_stack.frames.push_back(fn);
+}
+
+void Sampler::pop() {
+    std::lock_guard<std::mutex> lock(tls_stack.mutex);
+    tls_stack.frames.pop_back();
+}
+
+void Sampler::frame_mark() {
+    std::lock_guard<std::mutex> data(g_data_mutex);
+    // At 1kHz one sample is roughly one millisecond of script time.
+    if (g_frame_samples > g_worst_samples) {
+        g_worst_samples = g_frame_samples;
+        g_worst_frame = g_frame_index;
+        std::fprintf(stderr,
+                     "wave: new worst frame #%llu: %llu sample(s) (~%llu "
+                     "ms)\n",
+                     (unsigned long long)g_worst_frame,
+                     (unsigned long long)g_worst_samples,
+                     (unsigned long long)g_worst_samples);
+    }
+    g_frame_index++;
+    g_frame_samples = 0;
+}
+
+bool Sampler::report(const std::string& path) {
+    g_enabled.store(false, std::memory_order_release);
+    // Let an in-flight sampling pass drain before reading the data.
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    std::lock_guard<std::mutex> data(g_data_mutex);
+
+    std::ofstream out(path, std::ios::trunc);
+    if (!out)
+        return false;
+    for (const auto& entry : g_collapsed)
+        out << entry.first << ' ' << entry.second << '\n';
+
+    std::fprintf(stderr, "wave: %llu sample(s) across %llu frame(s) -> %s\n",
+                 (unsigned long long)g_total_samples,
+                 (unsigned long long)g_frame_index, path.c_str());
+    if (g_worst_samples)
+        std::fprintf(stderr, "wave: worst frame #%llu: %llu sample(s)\n",
+                     (unsigned long long)g_worst_frame,
+                     (unsigned long long)g_worst_samples);
+    return true;
+}
+
+} // namespace wave
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <string>
+
+#include "interner.h"
+
+namespace wave {
+
+// Sampling profiler for the bytecode tier.
+//
+// The interpreter maintains a shadow stack of function names per
+// thread; a sampler thread snapshots every live stack at 1kHz and
+// aggregates identical stacks. When sampling is off — the default —
+// the interpreter's only cost is one predicted branch per call and
+// return, so the hooks are always compiled in. When it is on, call and
+// return additionally push and pop one Symbol under an uncontended
+// per-thread lock.
+//
+// Programs declare their frame boundary with the builtin `frame()`
+// statement; samples aggregate per frame so the output answers "which
+// frame was slow" as well as "which function is hot". A frame that sets
+// a new worst is reported live on stderr as it ends. The final report
+// is collapsed-stack format ("main;update;physics 42", one line per
+// unique stack), which flamegraph.pl and every flame viewer consume
+// directly.
+class Sampler {
+public:
+    // The process-wide sampler; the sampling thread starts on enable.
+    static Sampler& global();
+
+    // Starts the 1kHz sampling thread. Enable before running code;
+    // threads entering the interpreter afterwards attach themselves.
+    void enable();
+
+    bool enabled() const;
+
+    // Interpreter hooks, only called while enabled: attach registers
+    // the calling thread's shadow stack with the root function pushed,
+    // detach unregisters it at activation exit.
+    void attach(Symbol fn);
+    void detach();
+    void push(Symbol fn);
+    void pop();
+
+    // Ends the current frame (the `frame()` builtin). Reports a new
+    // worst frame live on stderr.
+    void frame_mark();
+
+    // Stops sampling and writes the collapsed stacks to `path`;
+    // prints the per-frame summary to stderr. Returns false if the
+    // file cannot be written.
+    bool report(const std::string& path);
+};
+
+} // namespace wave
@@ -0,0 +1,365 @@
+#include "sema.h"
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "batch.h"
+#include "diag.h"
+#include "generics.h"
+#include "structs.h"
+
+namespace wave {
+
+namespace {
+
+class Sema {
+public:
+    explicit Sema(Module& module)
+        : module_(module), generics_(module), sym_print_(intern("print")) {}
+
+    void run(const std::unordered_set<Symbol>* dirty = nullptr) {
+        for (FunDecl* fun : module_.functions) {
+            if (!functions_.emplace(fun->name, fun).second)
+                fail(*fun, "duplicate function '" +
+                               std::string(sym_text(fun->name)) + "'");
+        }
+        // Templates are only checked as specializations; their bodies
+        // have open type parameters until a call site binds them. With
+        // a dirty set, unchanged functions are skipped wholesale.
+        for (FunDecl* fun : module_.functions)
+            if (fun->type_params.empty() &&
+                (!dirty || dirty->count(fun->name)))
+                check_function(*fun);
+        // Checking mints specializations, and their bodies can mint
+        // more; drain in creation order.
+        for (size_t i = 0; i < generics_.instantiations().size(); i++)
+            check_function(*generics_.instantiations()[i]);
+        // Rebuild the function list as concrete functions plus
+        // specializations, so lowering and the inliner never see a
+        // template.
+        std::vector<FunDecl*> concrete;
+        for (FunDecl* fun : module_.functions)
+            if (fun->type_params.empty())
+                concrete.push_back(fun);
+        for (FunDecl* fun : generics_.instantiations())
+            concrete.push_back(fun);
+        module_.functions = module_.arena.copy_span(concrete);
+    }
+
+private:
+    void check_function(FunDecl& fun) {
+        scope_.clear();
+        for (const Param& param : fun.params)
+            declare(fun, param.name, named_type(fun, param.type_name));
+        for (Stmt* stmt : fun.body)
+            check_stmt(*stmt);
+    }
+
+    void check_stmt(Stmt& stmt) {
+        if (stmt.kind == StmtKind::Spawn) {
+            auto& spawn = static_cast<SpawnStmt&>(stmt);
+            // Only user functions run as tasks; print and the vector
+            // builtins have nothing to parallelize.
+            if (spawn.call->callee == sym_print_ ||
+                sym_text(spawn.call->callee) == "frame" ||
+                vec_ctor_type(sym_text(spawn.call->callee)) != Type::Void ||
+                is_vec_binop(sym_text(spawn.call->callee)))
+                fail(*spawn.call, "'spawn' expects a call to a 'fun'");
+            in_spawn_ = true;
+            check_expr(spawn.call);
+            in_spawn_ = false;
+            return;
+        }
+        if (stmt.kind == StmtKind::VarDecl) {
+            auto& decl = static_cast<VarDeclStmt&>(stmt);
+            Type init_type = check_expr(decl.init);
+            Type type = decl.type_name != kNoSymbol
+                            ? named_type(decl, decl.type_name)
+                            : init_type;
+            if (decl.type_name != kNoSymbol && type != init_type)
+                fail(decl, "initializer type does not match ':" +
+                               std::string(sym_text(decl.type_name)) + "'");
+            declare(decl, decl.name, type);
+        } else {
+            auto& expr_stmt = static_cast<ExprStmt&>(stmt);
+            expr_stmt.expr = check_call_or_lower(expr_stmt.expr);
+        }
+    }
+
+    // Checks an expression statement's expression, rewriting `print` calls
+    // into their lowered PrintExpr form.
+    Expr* check_call_or_lower(Expr* expr) {
+        if (expr->kind == ExprKind::Call &&
+            static_cast<CallExpr*>(expr)->callee == sym_print_)
+            return lower_print(*static_cast<CallExpr*>(expr));
+        check_expr(expr);
+        return expr;
+    }
+
+    Type check_expr(Expr* expr) {
+        switch (expr->kind) {
+        case ExprKind::IntLit:
+            return Type::Int;
+        case ExprKind::FloatLit:
+            return Type::Float;
+        case ExprKind::StrLit:
+            return Type::Str;
+        case ExprKind::Ident: {
+            auto& ident = static_cast<IdentExpr&>(*expr);
+            auto it = scope_.find(ident.name);
+            if (it == scope_.end())
+                fail(ident, "use of undeclared name '" +
+                                std::string(sym_text(ident.name)) + "'");
+            return it->second;
+        }
+        case ExprKind::Call: {
+            auto& call = static_cast<CallExpr&>(*expr);
+            if (call.callee == sym_print_)
+                fail(call, "'print' is a statement, not a value");
+            // Vector builtins are calls that produce values.
+            Type vec = vec_ctor_type(sym_text(call.callee));
+            if (vec != Type::Void) {
+                if (call.args.size() != vec_lanes(vec))
+                    fail(call, "'" + std::string(sym_text(call.callee)) +
+                                   "' expects " +
+                                   std::to_string(vec_lanes(vec)) +
+                                   " components");
+                for (Expr* arg : call.args) {
+                    Type component = check_expr(arg);
+                    if (component != Type::Float && component != Type::Int)
+                        fail(*arg, "vector components must be numeric");
+                }
+                return vec;
+            }
+            if (is_vec_binop(sym_text(call.callee))) {
+                if (call.args.size() != 2)
+                    fail(call, "'" + std::string(sym_text(call.callee)) +
+                                   "' expects 2 arguments");
+                Type lhs = check_expr(call.args[0]);
+                Type rhs = check_expr(call.args[1]);
+                if (vec_lanes(lhs) == 0 || lhs != rhs)
+                    fail(call, "'" + std::string(sym_text(call.callee)) +
+                                   "' expects two vectors of the same type");
+                return lhs;
+            }
+            if (sym_text(call.callee) == "frame") {
+                if (!call.args.empty())
+                    fail(call, "'frame' takes no arguments");
+                return Type::Void;
+            }
+            if (sym_text(call.callee) == "substr") {
+                if (call.args.size() != 3)
+                    fail(call, "'substr' expects (str, start, len)");
+                if (check_expr(call.args[0]) != Type::Str)
+                    fail(*call.args[0], "'substr' expects a string");
+                for (int i = 1; i < 3; i++)
+                    if (check_expr(call.args[i]) != Type::Int)
+                        fail(*call.args[i],
+                             "'substr' bounds must be integers");
+                return Type::Str;
+            }
+            auto it = functions_.find(call.callee);
+            if (it == functions_.end())
+                fail(call, "call to undeclared function '" +
+                               std::string(sym_text(call.callee)) + "'");
+            const FunDecl& target = *it->second;
+            if (target.is_async && !in_spawn_)
+                fail(call, "async fun '" +
+                               std::string(sym_text(call.callee)) +
+                               "' must be entered with 'spawn'");
+            if (call.args.size() != target.params.size())
+                fail(call, "'" + std::string(sym_text(call.callee)) +
+                               "' expects " +
+                               std::to_string(target.params.size()) +
+                               " argument(s), got " +
+                               std::to_string(call.args.size()));
+            if (!target.type_params.empty())
+                return check_generic_call(call, target);
+            for (uint32_t i = 0; i < call.args.size(); i++) {
+                Type arg = check_expr(call.args[i]);
+                Type want = named_type(call, target.params[i].type_name);
+                if (arg != want)
+                    fail(*call.args[i],
+                         "argument type mismatch for parameter '" +
+                             std::string(sym_text(target.params[i].name)) +
+                             "'");
+            }
+            return Type::Void;
+        }
+        case ExprKind::Field:
+            fail(*expr, "field access survived struct expansion"); // bug
+        case ExprKind::ArrayLit:
+            fail(*expr, "array literal survived batch expansion"); // bug
+        case ExprKind::Print:
+            fail(*expr, "print already lowered"); // sema runs once
+        }
+        return Type::Void;
+    }
+
+    // Deduces a template's type parameters from the call's argument
+    // types, C++-style, and swaps the call over to the (cached)
+    // specialization. From here on the call is ordinary: monomorphized
+    // code keeps concrete layouts and inlines like anything else.
+    Type check_generic_call(CallExpr& call, const FunDecl& templ) {
+        auto is_type_param = [&](Symbol name) {
+            for (Symbol type_param : templ.type_params)
+                if (type_param == name)
+                    return true;
+            return false;
+        };
+        std::unordered_map<Symbol, Type> bindings;
+        for (uint32_t i = 0; i < call.args.size(); i++) {
+            Type arg = check_expr(call.args[i]);
+            Symbol want = templ.params[i].type_name;
+            if (!is_type_param(want)) {
+                if (arg != named_type(call, want))
+                    fail(*call.args[i],
+                         "argument type mismatch for parameter '" +
+                             std::string(sym_text(templ.params[i].name)) +
+                             "'");
+                continue;
+            }
+            auto bound = bindings.emplace(want, arg);
+            if (!bound.second && bound.first->second != arg)
+                fail(*call.args[i],
+                     "conflicting deductions for type parameter '" +
+                         std::string(sym_text(want)) + "'");
+        }
+        for (Symbol type_param : templ.type_params)
+            if (!bindings.count(type_param))
+                fail(call, "cannot deduce type parameter '" +
+                               std::string(sym_text(type_param)) +
+                               "' from the call's arguments");
+        call.callee = generics_.instantiate(templ, bindings)->name;
+        return Type::Void;
+    }
+
+    // Compile-time format lowering: print("a {x} {}", y) becomes
+    // [WriteLit "a ", WriteStr/Int x, WriteLit " ", WriteStr/Int y,
+    //  WriteLit "\n"].
+    PrintExpr* lower_print(CallExpr& call) {
+        if (call.args.empty() || call.args[0]->kind != ExprKind::StrLit)
+            fail(call, "print expects a string literal format");
+        std::string_view fmt =
+            sym_text(static_cast<StrLitExpr*>(call.args[0])->value);
+
+        std::vector<PrintOp> ops;
+        std::string literal;
+        uint32_t next_positional = 1;
+
+        auto flush_literal = [&] {
+            if (literal.empty())
+                return;
+            PrintOp op;
+            op.kind = PrintOpKind::WriteLit;
+            op.literal = intern(literal);
+            ops.push_back(op);
+            literal.clear();
+        };
+        auto push_arg = [&](Expr* arg) {
+            flush_literal();
+            PrintOp op;
+            switch (check_expr(arg)) {
+            case Type::Int:   op.kind = PrintOpKind::WriteInt; break;
+            case Type::Float: op.kind = PrintOpKind::WriteFloat; break;
+            case Type::Str:   op.kind = PrintOpKind::WriteStr; break;
+            case Type::Vec2:
+            case Type::Vec3:
+            case Type::Vec4:  op.kind = PrintOpKind::WriteVec; break;
+            case Type::Void:  fail(*arg, "cannot print a void value");
+            }
+            op.arg = arg;
+            ops.push_back(op);
+        };
+
+        for (size_t i = 0; i < fmt.size(); i++) {
+            char c = fmt[i];
+            if (c == '{' && i + 1 < fmt.size() && fmt[i + 1] == '{') {
+                literal += '{';
+                i++;
+            } else if (c == '}' && i + 1 < fmt.size() && fmt[i + 1] == '}') {
+                literal += '}';
+                i++;
+            } else if (c == '{') {
+                size_t close = fmt.find('}', i + 1);
+                if (close == std::string_view::npos)
+                    fail(call, "unterminated '{' in format string");
+                std::string_view capture = fmt.substr(i + 1, close - i - 1);
+                if (capture.empty()) {
+                    if (next_positional >= call.args.size())
+                        fail(call, "not enough arguments for format string");
+                    push_arg(call.args[next_positional++]);
+                } else {
+                    IdentExpr* ident =
+                        module_.make<IdentExpr>(call.line, call.col);
+                    ident->name = intern(capture);
+                    push_arg(ident);
+                }
+                i = close;
+            } else if (c == '}') {
+                fail(call, "unmatched '}' in format string");
+            } else {
+                literal += c;
+            }
+        }
+        if (next_positional != call.args.size())
+            fail(call, "too many arguments for format string");
+        literal += '\n';
+        flush_literal();
+
+        PrintExpr* print = module_.make<PrintExpr>(call.line, call.col);
+        print->ops = module_.arena.copy_span(ops);
+        return print;
+    }
+
+    Type named_type(const Node& at, Symbol name) {
+        std::string_view text = sym_text(name);
+        if (text == "str" || text == "String")
+            return Type::Str;
+        if (text == "int" || text == "i32" || text == "i64")
+            return Type::Int;
+        if (text == "f32" || text == "float")
+            return Type::Float;
+        Type vec = vec_ctor_type(text);
+        if (vec != Type::Void)
+            return vec;
+        fail(at, "unknown type '" + std::string(text) + "'");
+    }
+
+    void declare(const Node& at, Symbol name, Type type) {
+        if (!scope_.emplace(name, type).second)
+            fail(at, "redeclaration of '" + std::string(sym_text(name)) + "'");
+    }
+
+    [[noreturn]] void fail(const Node& at, const std::string& msg) {
+        error(module_.file_name, at.line, at.col, msg);
+        throw CompileError();
+    }
+
+    Module& module_;
+    GenericInstantiator generics_;
+    Symbol sym_print_;
+    std::unordered_map<Symbol, FunDecl*> functions_;
+    std::unordered_map<Symbol, Type> scope_;
+    bool in_spawn_ = false;
+};
+
+} // namespace
+
+void analyze_module(Module& module) {
+    expand_batches(module);
+    expand_structs(module);
+    transpose_soa(module);
+    Sema(module).run();
+}
+
+void analyze_module(Module& module, const std::unordered_set<Symbol>& dirty) {
+    expand_batches(module);
+    expand_structs(module);
+    transpose_soa(module);
+    Sema(module).run(&dirty);
+}
+
+} // namespace wave
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <unordered_set>
+
+#include "ast.h"
+
+namespace wave {
+
+// Semantic analysis over a parsed module: resolves names, infers the
+// minimal types the backend needs, and lowers `print` calls in place.
+//
+// Format strings are parsed here, once, at compile time: `{}` consumes the
+// next positional argument and `{name}` captures a binding from the
+// enclosing scope. The call is rewritten into a PrintExpr holding a flat
+// sequence of typed write ops, so the runtime never scans braces.
+//
+// Throws CompileError on the first semantic error.
+void analyze_module(Module& module);
+
+// Incremental variant for the language server: expansion and name
+// registration run over the whole module as usual, but only the
+// functions named in `dirty` are re-checked. The caller guarantees the
+// rest checked clean against the same signatures and struct layouts.
+void analyze_module(Module& module, const std::unordered_set<Symbol>& dirty);
+
+} // namespace wave
@@ -0,0 +1,172 @@
+#include "snapshot.h"
+
+#include <cstring>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace wave {
+
+std::string write_snapshot_bytes(const BcProgram& program) {
+    std::vector<SnapFun> funs;
+    std::vector<Insn> code;
+    std::vector<SnapConst> consts;
+    std::string strings;
+
+    auto add_string = [&](std::string_view text) {
+        SnapString str{(uint32_t)strings.size(), (uint32_t)text.size()};
+        strings.append(text.data(), text.size());
+        return str;
+    };
+
+    for (const BcFunction& fn : program.functions) {
+        SnapFun fun;
+        std::memset(&fun, 0, sizeof(fun));
+        fun.name = add_string(sym_text(fn.name));
+        fun.code_index = (uint32_t)code.size();
+        fun.code_count = (uint32_t)fn.code.size();
+        fun.const_index = (uint32_t)consts.size();
+        fun.const_count = (uint32_t)fn.constants.size();
+        fun.num_params = fn.num_params;
+        fun.num_regs = fn.num_regs;
+        code.insert(code.end(), fn.code.begin(), fn.code.end());
+        for (const Value& value : fn.constants) {
+            SnapConst k;
+            std::memset(&k, 0, sizeof(k));
+            k.tag = (uint32_t)value.tag;
+            if (value.tag == Type::Int) {
+                std::memcpy(k.bits, &value.int_v, 8);
+            } else if (value.tag == Type::Float) {
+                std::memcpy(k.bits, &value.f32_v, 4);
+            } else if (vec_lanes(value.tag)) {
+                std::memcpy(k.bits, value.vec_v, 16);
+            } else {
+                SnapString str =
+                    add_string({value.str_data, value.str_len});
+                std::memcpy(k.bits, &str, 8);
+            }
+            consts.push_back(k);
+        }
+        funs.push_back(fun);
+    }
+
+    SnapHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.magic = kSnapMagic;
+    header.version = kSnapVersion;
+    header.fun_count = (uint32_t)funs.size();
+    header.main_index = program.main_index;
+    header.fun_table_off = sizeof(SnapHeader);
+    header.code_off =
+        header.fun_table_off + (uint32_t)(funs.size() * sizeof(SnapFun));
+    header.const_table_off =
+        header.code_off + (uint32_t)(code.size() * sizeof(Insn));
+    header.strings_off = header.const_table_off +
+                         (uint32_t)(consts.size() * sizeof(SnapConst));
+    header.strings_len = (uint32_t)strings.size();
+
+    std::string bytes;
+    bytes.reserve(header.strings_off + strings.size());
+    bytes.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    bytes.append(reinterpret_cast<const char*>(funs.data()),
+                 funs.size() * sizeof(SnapFun));
+    bytes.append(reinterpret_cast<const char*>(code.data()),
+                 code.size() * sizeof(Insn));
+    bytes.append(reinterpret_cast<const char*>(consts.data()),
+                 consts.size() * sizeof(SnapConst));
+    bytes += strings;
+    return bytes;
+}
+
+MappedSnapshot::~MappedSnapshot() {
+    if (base_)
+        ::munmap(const_cast<char*>(base_), size_);
+}
+
+bool MappedSnapshot::load(const std::string& path, BcProgram& out) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(SnapHeader)) {
+        ::close(fd);
+        return false;
+    }
+    void* mapping =
+        ::mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED)
+        return false;
+    base_ = static_cast<const char*>(mapping);
+    size_ = (size_t)st.st_size;
+
+    // Validate before anyone indexes through the tables.
+    const auto& hdr = *reinterpret_cast<const SnapHeader*>(base_);
+    uint64_t fun_end = (uint64_t)hdr.fun_table_off +
+                       (uint64_t)hdr.fun_count * sizeof(SnapFun);
+    uint64_t str_end = (uint64_t)hdr.strings_off + hdr.strings_len;
+    // Sections must appear in declaration order: the per-function
+    // bounds below derive table capacities from adjacent offsets, and
+    // an image whose sections run backwards would wrap them.
+    if (hdr.magic != kSnapMagic || hdr.version != kSnapVersion ||
+        hdr.fun_table_off < sizeof(SnapHeader) || fun_end > size_ ||
+        hdr.code_off < fun_end || hdr.const_table_off < hdr.code_off ||
+        hdr.strings_off < hdr.const_table_off || str_end > size_ ||
+        hdr.main_index >= hdr.fun_count)
+        return false;
+
+    const auto* funs =
+        reinterpret_cast<const SnapFun*>(base_ + hdr.fun_table_off);
+    const auto* code = reinterpret_cast<const Insn*>(base_ + hdr.code_off);
+    const auto* consts =
+        reinterpret_cast<const SnapConst*>(base_ + hdr.const_table_off);
+    const char* strings = base_ + hdr.strings_off;
+    uint64_t code_max = (hdr.const_table_off - hdr.code_off) / sizeof(Insn);
+    uint64_t const_max =
+        (hdr.strings_off - hdr.const_table_off) / sizeof(SnapConst);
+
+    out.functions.resize(hdr.fun_count);
+    out.main_index = (uint16_t)hdr.main_index;
+    for (uint32_t f = 0; f < hdr.fun_count; f++) {
+        const SnapFun& snap = funs[f];
+        if ((uint64_t)snap.code_index + snap.code_count > code_max ||
+            (uint64_t)snap.const_index + snap.const_count > const_max ||
+            (uint64_t)snap.name.off + snap.name.len > hdr.strings_len)
+            return false;
+        BcFunction& fn = out.functions[f];
+        fn.name = intern({strings + snap.name.off, snap.name.len});
+        fn.num_params = (uint8_t)snap.num_params;
+        fn.num_regs = (uint8_t)snap.num_regs;
+        fn.code.assign(code + snap.code_index,
+                       code + snap.code_index + snap.code_count);
+        fn.constants.resize(snap.const_count);
+        for (uint32_t c = 0; c < snap.const_count; c++) {
+            const SnapConst& k = consts[snap.const_index + c];
+            Value& value = fn.constants[c];
+            value.tag = (Type)k.tag;
+            if (value.tag == Type::Int) {
+                std::memcpy(&value.int_v, k.bits, 8);
+            } else if (value.tag == Type::Float) {
+                std::memcpy(&value.f32_v, k.bits, 4);
+            } else if (vec_lanes(value.tag)) {
+                std::memcpy(value.vec_v, k.bits, 16);
+            } else {
+                // Borrow the mapping's bytes: string constants are
+                // never copied out of the image.
+                SnapString str;
+                std::memcpy(&str, k.bits, 8);
+                if ((uint64_t)str.off + str.len > hdr.strings_len)
+                    return false;
+                value.str_data = strings + str.off;
+                value.str_len = str.len;
+            }
+        }
+        out.by_name.emplace(fn.name, (uint16_t)f);
+    }
+    return true;
+}
+
+} // namespace wave
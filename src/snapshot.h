@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "bytecode.h"
+
+namespace wave {
+
+// Startup snapshot format (.img): a fully lowered program image.
+//
+// `wave snapshot` runs the whole front end — parse, analysis, inlining,
+// lowering — once, and serializes the finished bytecode program.
+// `wave run --snapshot` maps the file and jumps straight to `main`:
+// no lexing, no parsing, no type checking, no lowering. Like .wvm
+// modules the file is position-independent — fixed-width little-endian
+// records, offsets instead of pointers — so loading is one mmap, a
+// bounds check, and a memcpy of each function's instruction stream.
+// String constants are not copied at all; their slices borrow the
+// mapping's bytes directly, which is why the mapping must outlive the
+// program (MappedSnapshot keeps it alive).
+//
+// Layout:
+//   SnapHeader
+//   SnapFun[fun_count]         (at header.fun_table_off)
+//   Insn stream                (at header.code_off)
+//   SnapConst[...]             (at header.const_table_off)
+//   string bytes               (at header.strings_off)
+
+constexpr uint32_t kSnapMagic = 0x31495657; // "WVI1"
+constexpr uint32_t kSnapVersion = 1;
+
+struct SnapHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t fun_count;
+    uint32_t main_index;
+    uint32_t fun_table_off;
+    uint32_t code_off;
+    uint32_t const_table_off;
+    uint32_t strings_off;
+    uint32_t strings_len;
+    uint32_t reserved;
+};
+
+struct SnapString {
+    uint32_t off; // into the string-bytes section
+    uint32_t len;
+};
+
+// One constant-pool entry. `bits` holds the value for every tag:
+// integers and floats by bit pattern, vectors as four f32 lanes, and
+// strings as a SnapString in the first eight bytes.
+struct SnapConst {
+    uint32_t tag; // Type enum value
+    uint32_t pad;
+    uint32_t bits[4];
+};
+
+struct SnapFun {
+    SnapString name;
+    uint32_t code_index;  // first Insn in the code section
+    uint32_t code_count;
+    uint32_t const_index; // first SnapConst in the constant table
+    uint32_t const_count;
+    uint16_t num_params;
+    uint16_t num_regs;
+    uint32_t pad;
+};
+
+static_assert(sizeof(SnapHeader) == 40, "mapped layout is ABI");
+static_assert(sizeof(SnapConst) == 24, "mapped layout is ABI");
+static_assert(sizeof(SnapFun) == 32, "mapped layout is ABI");
+
+// Serializes a lowered program into the .img byte layout.
+std::string write_snapshot_bytes(const BcProgram& program);
+
+// A mapped .img file plus the program decoded from it. The mapping
+// backs the program's string constants, so keep the object alive for
+// as long as the program runs.
+class MappedSnapshot {
+public:
+    MappedSnapshot() = default;
+    MappedSnapshot(const MappedSnapshot&) = delete;
+    MappedSnapshot& operator=(const MappedSnapshot&) = delete;
+    ~MappedSnapshot();
+
+    // Maps and validates `path`, then decodes it into `out`. Returns
+    // false (and stays invalid) on a missing, truncated or
+    // wrong-version file.
+    bool load(const std::string& path, BcProgram& out);
+
+private:
+    const char* base_ = nullptr;
+    size_t size_ = 0;
+};
+
+} // namespace wave
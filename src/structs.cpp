@@ -0,0 +1,340 @@
+#include "structs.h"
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "diag.h"
+
+namespace wave {
+
+namespace {
+
+bool is_scalar_type_name(std::string_view text) {
+    return text == "str" || text == "String" || text == "int" ||
+           text == "i32" || text == "i64" || text == "f32" ||
+           text == "float" || vec_ctor_type(text) != Type::Void;
+}
+
+class StructExpander {
+public:
+    explicit StructExpander(Module& module) : module_(module) {}
+
+    void run() {
+        for (const StructDecl* decl : module_.structs) {
+            if (!structs_.emplace(decl->name, decl).second)
+                fail(*decl, "duplicate struct '" +
+                                std::string(sym_text(decl->name)) + "'");
+        }
+        for (const StructDecl* decl : module_.structs)
+            check_fields(*decl);
+        if (structs_.empty())
+            return;
+        for (FunDecl* fun : module_.functions)
+            expand_function(*fun);
+    }
+
+private:
+    void check_fields(const StructDecl& decl) {
+        std::unordered_set<Symbol> seen;
+        for (const Param& field : decl.fields) {
+            if (!seen.insert(field.name).second)
+                fail(decl, "duplicate field '" +
+                               std::string(sym_text(field.name)) + "'");
+            std::string_view type = sym_text(field.type_name);
+            if (!is_scalar_type_name(type) && !structs_.count(field.type_name))
+                fail(decl, "unknown field type '" + std::string(type) + "'");
+        }
+        // Flattening recurses through struct-typed fields; containment
+        // cycles would never terminate.
+        std::unordered_set<Symbol> trail;
+        check_cycle(decl, trail);
+    }
+
+    void check_cycle(const StructDecl& decl,
+                     std::unordered_set<Symbol>& trail) {
+        if (!trail.insert(decl.name).second)
+            fail(decl, "struct '" + std::string(sym_text(decl.name)) +
+                           "' contains itself");
+        for (const Param& field : decl.fields) {
+            auto it = structs_.find(field.type_name);
+            if (it != structs_.end())
+                check_cycle(*it->second, trail);
+        }
+        trail.erase(decl.name);
+    }
+
+    // Appends `prefix.path :leaf_type` entries for every leaf field.
+    void flatten(const StructDecl& decl, const std::string& prefix,
+                 std::vector<Param>& out) {
+        for (const Param& field : decl.fields) {
+            std::string path =
+                prefix + "." + std::string(sym_text(field.name));
+            auto it = structs_.find(field.type_name);
+            if (it != structs_.end()) {
+                flatten(*it->second, path, out);
+            } else {
+                Param leaf;
+                leaf.name = intern(path);
+                leaf.type_name = field.type_name;
+                out.push_back(leaf);
+            }
+        }
+    }
+
+    void expand_function(FunDecl& fun) {
+        locals_.clear();
+        std::vector<Param> params;
+        for (const Param& param : fun.params) {
+            auto it = structs_.find(param.type_name);
+            if (it == structs_.end()) {
+                params.push_back(param);
+                continue;
+            }
+            locals_.emplace(param.name, it->second);
+            flatten(*it->second, std::string(sym_text(param.name)), params);
+        }
+        fun.params = module_.arena.copy_span(params);
+
+        std::vector<Stmt*> body;
+        for (Stmt* stmt : fun.body)
+            expand_stmt(stmt, body);
+        fun.body = module_.arena.copy_span(body);
+    }
+
+    void expand_stmt(Stmt* stmt, std::vector<Stmt*>& body) {
+        if (stmt->kind == StmtKind::Spawn) {
+            auto* spawn = static_cast<SpawnStmt*>(stmt);
+            spawn->call = static_cast<CallExpr*>(rewrite(spawn->call));
+            body.push_back(stmt);
+            return;
+        }
+        if (stmt->kind != StmtKind::VarDecl) {
+            auto* expr_stmt = static_cast<ExprStmt*>(stmt);
+            expr_stmt->expr = rewrite(expr_stmt->expr);
+            body.push_back(stmt);
+            return;
+        }
+
+        auto* decl = static_cast<VarDeclStmt*>(stmt);
+        const StructDecl* annotated = decl->type_name != kNoSymbol
+                                          ? find_struct(decl->type_name)
+                                          : nullptr;
+        std::string src_path;
+        const StructDecl* init_type = struct_value(decl->init, src_path);
+        if (!init_type && !annotated) {
+            decl->init = rewrite(decl->init);
+            body.push_back(decl);
+            return;
+        }
+
+        // A struct binding: splice one binding per leaf field.
+        if (annotated && init_type && annotated != init_type)
+            fail(*decl, "initializer type does not match ':" +
+                            std::string(sym_text(decl->type_name)) + "'");
+        if (!init_type)
+            fail(*decl, "struct binding requires a constructor or a "
+                        "struct value");
+        locals_.emplace(decl->name, init_type);
+        std::string dst = std::string(sym_text(decl->name));
+        if (decl->init->kind == ExprKind::Call &&
+            static_cast<CallExpr*>(decl->init)->callee == init_type->name)
+            bind_ctor(*decl, dst, *init_type,
+                      *static_cast<CallExpr*>(decl->init), body);
+        else
+            bind_move(*decl, dst, src_path, *init_type, body);
+    }
+
+    // var p = Particle(a, b, c): one binding per field, recursing into
+    // struct-typed fields.
+    void bind_ctor(const VarDeclStmt& at, const std::string& dst,
+                   const StructDecl& type, CallExpr& ctor,
+                   std::vector<Stmt*>& body) {
+        if (ctor.args.size() != type.fields.size())
+            fail(ctor, "'" + std::string(sym_text(type.name)) + "' has " +
+                           std::to_string(type.fields.size()) +
+                           " field(s), got " +
+                           std::to_string(ctor.args.size()));
+        for (uint32_t i = 0; i < type.fields.size(); i++) {
+            const Param& field = type.fields[i];
+            std::string path =
+                dst + "." + std::string(sym_text(field.name));
+            const StructDecl* nested = find_struct(field.type_name);
+            Expr* arg = ctor.args[i];
+            if (nested) {
+                std::string src;
+                const StructDecl* arg_type = struct_value(arg, src);
+                if (arg_type != nested)
+                    fail(*arg, "field '" +
+                                   std::string(sym_text(field.name)) +
+                                   "' expects a '" +
+                                   std::string(sym_text(nested->name)) +
+                                   "' value");
+                if (arg->kind == ExprKind::Call &&
+                    static_cast<CallExpr*>(arg)->callee == nested->name)
+                    bind_ctor(at, path, *nested,
+                              *static_cast<CallExpr*>(arg), body);
+                else
+                    bind_move(at, path, src, *nested, body);
+                continue;
+            }
+            VarDeclStmt* leaf = module_.make<VarDeclStmt>(at.line, at.col);
+            leaf->is_count = at.is_count;
+            leaf->is_soa = at.is_soa;
+            leaf->name = intern(path);
+            leaf->type_name = field.type_name;
+            leaf->init = rewrite(arg);
+            body.push_back(leaf);
+        }
+    }
+
+    // var q = p: per-field moves from the source's bindings.
+    void bind_move(const VarDeclStmt& at, const std::string& dst,
+                   const std::string& src, const StructDecl& type,
+                   std::vector<Stmt*>& body) {
+        std::vector<Param> leaves;
+        flatten(type, "", leaves);
+        for (const Param& leaf : leaves) {
+            std::string path(sym_text(leaf.name)); // ".field[.sub]"
+            VarDeclStmt* copy = module_.make<VarDeclStmt>(at.line, at.col);
+            copy->is_count = at.is_count;
+            copy->is_soa = at.is_soa;
+            copy->name = intern(dst + path);
+            copy->type_name = leaf.type_name;
+            IdentExpr* from = module_.make<IdentExpr>(at.line, at.col);
+            from->name = intern(src + path);
+            copy->init = from;
+            body.push_back(copy);
+        }
+    }
+
+    // Struct decl if `expr` denotes a whole struct value — a local, a
+    // struct-typed field path, or a constructor call — else null.
+    // Fills `path` with the flattened binding prefix for the former two.
+    const StructDecl* struct_value(const Expr* expr, std::string& path) {
+        if (expr->kind == ExprKind::Ident) {
+            auto it = locals_.find(static_cast<const IdentExpr*>(expr)->name);
+            if (it == locals_.end())
+                return nullptr;
+            path = std::string(
+                sym_text(static_cast<const IdentExpr*>(expr)->name));
+            return it->second;
+        }
+        if (expr->kind == ExprKind::Field) {
+            const auto* access = static_cast<const FieldExpr*>(expr);
+            const StructDecl* base = struct_value(access->base, path);
+            if (!base)
+                return nullptr;
+            const Param* field = find_field(*base, access->field);
+            if (!field)
+                fail(*access, "no field '" +
+                                  std::string(sym_text(access->field)) +
+                                  "' in '" +
+                                  std::string(sym_text(base->name)) + "'");
+            path += "." + std::string(sym_text(access->field));
+            return find_struct(field->type_name); // null for leaf fields
+        }
+        if (expr->kind == ExprKind::Call) {
+            const auto* call = static_cast<const CallExpr*>(expr);
+            return find_struct(call->callee);
+        }
+        return nullptr;
+    }
+
+    // Rewrites an expression in scalar position: field paths become
+    // their flattened bindings, call arguments expand struct values.
+    Expr* rewrite(Expr* expr) {
+        switch (expr->kind) {
+        case ExprKind::Field: {
+            auto* access = static_cast<FieldExpr*>(expr);
+            std::string path;
+            const StructDecl* base = struct_value(access->base, path);
+            if (!base)
+                fail(*access, "field access on a non-struct value");
+            const Param* field = find_field(*base, access->field);
+            if (!field)
+                fail(*access, "no field '" +
+                                  std::string(sym_text(access->field)) +
+                                  "' in '" +
+                                  std::string(sym_text(base->name)) + "'");
+            if (find_struct(field->type_name))
+                fail(*access, "whole-struct field '" +
+                                  std::string(sym_text(access->field)) +
+                                  "' used as a scalar");
+            IdentExpr* leaf = module_.make<IdentExpr>(access->line,
+                                                      access->col);
+            leaf->name = intern(path + "." +
+                                std::string(sym_text(access->field)));
+            return leaf;
+        }
+        case ExprKind::Call: {
+            auto* call = static_cast<CallExpr*>(expr);
+            if (find_struct(call->callee))
+                fail(*call, "struct constructor used outside a binding");
+            bool is_print = sym_text(call->callee) == "print";
+            std::vector<Expr*> args;
+            for (Expr* arg : call->args) {
+                std::string path;
+                const StructDecl* type = struct_value(arg, path);
+                if (type && is_print)
+                    fail(*arg, "cannot print a whole struct; print its "
+                               "fields");
+                if (type) {
+                    // A struct argument becomes its leaf fields, moved
+                    // straight into the callee's flattened parameters.
+                    std::vector<Param> leaves;
+                    flatten(*type, path, leaves);
+                    for (const Param& leaf : leaves) {
+                        IdentExpr* ident =
+                            module_.make<IdentExpr>(call->line, call->col);
+                        ident->name = leaf.name;
+                        args.push_back(ident);
+                    }
+                    continue;
+                }
+                args.push_back(rewrite(arg));
+            }
+            call->args = module_.arena.copy_span(args);
+            return call;
+        }
+        case ExprKind::Ident: {
+            auto it = locals_.find(static_cast<IdentExpr*>(expr)->name);
+            if (it != locals_.end())
+                fail(*expr, "struct value used as a scalar");
+            return expr;
+        }
+        default:
+            return expr;
+        }
+    }
+
+    const StructDecl* find_struct(Symbol name) const {
+        auto it = structs_.find(name);
+        return it != structs_.end() ? it->second : nullptr;
+    }
+
+    static const Param* find_field(const StructDecl& decl, Symbol name) {
+        for (const Param& field : decl.fields)
+            if (field.name == name)
+                return &field;
+        return nullptr;
+    }
+
+    [[noreturn]] void fail(const Node& at, const std::string& msg) const {
+        error(module_.file_name, at.line, at.col, msg);
+        throw CompileError();
+    }
+
+    Module& module_;
+    std::unordered_map<Symbol, const StructDecl*> structs_;
+    std::unordered_map<Symbol, const StructDecl*> locals_;
+};
+
+} // namespace
+
+void expand_structs(Module& module) {
+    StructExpander(module).run();
+}
+
+} // namespace wave
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "ast.h"
+
+namespace wave {
+
+// Scalar replacement for struct values, run before type checking.
+//
+// A `struct` is a pure value type: its fields live inline, in
+// declaration order, with no per-object header. This pass makes that
+// guarantee by construction — every struct value is flattened into its
+// leaf fields at compile time:
+//
+//   var p = Particle(pos, vel, 2.5)   one binding per leaf field
+//   p.vel                             the field's own binding
+//   var q = p                         per-field moves, no deep copy
+//   fun f(p :Particle)                one parameter per leaf field
+//
+// Flattened fields are named with dotted paths ("p.vel") so later
+// passes see ordinary scalars; registers and frame slots are assigned
+// in declaration order, which is the layout contract. Passing a struct
+// to a fun therefore moves its fields straight into the callee's frame
+// window — there is no boxed representation to copy.
+//
+// Nested structs flatten recursively; a struct that contains itself is
+// rejected. Throws CompileError on malformed struct code.
+void expand_structs(Module& module);
+
+} // namespace wave
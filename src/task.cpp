@@ -0,0 +1,101 @@
+#include "task.h"
+
+#include <chrono>
+#include <thread>
+
+namespace wave {
+
+namespace {
+
+// Pool worker index for the current thread, -1 outside the pool.
+thread_local int tls_worker = -1;
+
+} // namespace
+
+TaskScheduler& TaskScheduler::global() {
+    // Leaked deliberately: workers run for the process lifetime, and
+    // tearing them down during static destruction would race exits.
+    static TaskScheduler* scheduler = [] {
+        unsigned hw = std::thread::hardware_concurrency();
+        return new TaskScheduler(hw > 1 ? (int)hw : 1);
+    }();
+    return *scheduler;
+}
+
+TaskScheduler::TaskScheduler(int workers) : workers_(workers) {
+    for (size_t w = 0; w < workers_.size(); w++)
+        std::thread([this, w] { work(w); }).detach();
+}
+
+void TaskScheduler::spawn(const Task& task) {
+    size_t self = tls_worker >= 0 ? (size_t)tls_worker : 0;
+    {
+        std::lock_guard<std::mutex> lock(workers_[self].mutex);
+        workers_[self].deque.push_back(task);
+    }
+    wake();
+}
+
+void TaskScheduler::help_until(TaskGroup& group) {
+    size_t self = tls_worker >= 0 ? (size_t)tls_worker : 0;
+    while (group.pending.load(std::memory_order_acquire) > 0) {
+        Task task;
+        if (pop_own(self, task) || steal(self, task)) {
+            execute_task(task);
+            continue;
+        }
+        // Nothing runnable here; the group's last tasks are in flight
+        // on other workers. Sleep until a completion wakes us.
+        std::unique_lock<std::mutex> lock(idle_mutex_);
+        idle_cv_.wait_for(lock, std::chrono::milliseconds(1), [&] {
+            return group.pending.load(std::memory_order_acquire) == 0;
+        });
+    }
+}
+
+void TaskScheduler::complete(TaskGroup& group) {
+    group.pending.fetch_sub(1, std::memory_order_acq_rel);
+    wake();
+}
+
+void TaskScheduler::work(size_t self) {
+    tls_worker = (int)self;
+    for (;;) {
+        Task task;
+        if (pop_own(self, task) || steal(self, task)) {
+            execute_task(task);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(idle_mutex_);
+        idle_cv_.wait_for(lock, std::chrono::milliseconds(1));
+    }
+}
+
+bool TaskScheduler::pop_own(size_t self, Task& out) {
+    Worker& worker = workers_[self];
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    if (worker.deque.empty())
+        return false;
+    out = worker.deque.back();
+    worker.deque.pop_back();
+    return true;
+}
+
+bool TaskScheduler::steal(size_t self, Task& out) {
+    for (size_t i = 1; i < workers_.size(); i++) {
+        Worker& victim = workers_[(self + i) % workers_.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (victim.deque.empty())
+            continue;
+        out = victim.deque.front();
+        victim.deque.pop_front();
+        return true;
+    }
+    return false;
+}
+
+void TaskScheduler::wake() {
+    idle_cv_.notify_all();
+}
+
+} // namespace wave
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#include "bytecode.h"
+
+namespace wave {
+
+// Runtime task system behind `spawn`.
+//
+// A spawned call becomes a bounded Task object — function index plus
+// its arguments copied inline — pushed onto the spawning worker's
+// deque. Workers pop their own back and steal from other workers'
+// fronts, the same discipline the build driver uses for compilation
+// units, so hot fan-outs stay on one core's deque and idle cores pull
+// from the front where the oldest tasks sit.
+//
+// Concurrency is structured: every spawn joins a TaskGroup owned by
+// the spawning frame, and the frame's implicit join at function exit
+// runs tasks itself until the group drains. No task outlives the
+// function that spawned it.
+
+// Spawned arguments are stored inline; a Task never allocates.
+constexpr uint8_t kMaxTaskArgs = 6;
+
+struct TaskGroup {
+    std::atomic<uint64_t> pending{0};
+};
+
+struct Task {
+    const BcProgram* program = nullptr;
+    uint16_t fn = 0;
+    uint8_t argc = 0;
+    TaskGroup* group = nullptr;
+    Value args[kMaxTaskArgs];
+};
+
+// Executes one task's function on the calling thread (defined by the
+// interpreter) and signals its group.
+void execute_task(const Task& task);
+
+class TaskScheduler {
+public:
+    // The process-wide scheduler; its workers start on first use and
+    // live for the rest of the process.
+    static TaskScheduler& global();
+
+    // Queues a task on the calling worker's deque (or worker 0 for
+    // threads outside the pool). The task's group must already count it.
+    void spawn(const Task& task);
+
+    // Structured join: runs and steals tasks on the calling thread
+    // until `group` has no pending tasks left.
+    void help_until(TaskGroup& group);
+
+    // Marks one of `group`'s tasks finished and wakes joiners.
+    void complete(TaskGroup& group);
+
+private:
+    struct Worker {
+        std::deque<Task> deque;
+        std::mutex mutex;
+    };
+
+    explicit TaskScheduler(int workers);
+    void work(size_t self);
+    bool pop_own(size_t self, Task& out);
+    bool steal(size_t self, Task& out);
+    void wake();
+
+    std::vector<Worker> workers_;
+    std::mutex idle_mutex_;
+    std::condition_variable idle_cv_;
+};
+
+} // namespace wave
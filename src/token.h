@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+
+#include "interner.h"
+
+namespace wave {
+
+enum class TokenKind : uint8_t {
+    Eof,
+    Ident,
+    Int,
+    Float,      // floating literal; Wave floats are f32
+    Str,        // string literal, quotes stripped, escapes resolved
+    KwFun,
+    KwAsync,
+    KwVar,
+    KwCount,
+    KwStruct,
+    KwSpawn,
+    KwEach,
+    KwIn,
+    LParen,
+    RParen,
+    LBrace,
+    RBrace,
+    LBracket,
+    RBracket,
+    Colon,
+    Comma,
+    Dot,
+    Semicolon,
+    Equal,
+    At,
+};
+
+const char* token_kind_name(TokenKind kind);
+
+struct Token {
+    TokenKind kind = TokenKind::Eof;
+    uint32_t line = 1;
+    uint32_t col = 1;
+    Symbol sym = kNoSymbol; // interned spelling for Ident, contents for Str
+    int64_t int_value = 0;
+    float float_value = 0;
+};
+
+} // namespace wave
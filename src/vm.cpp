@@ -0,0 +1,267 @@
+#include "vm.h"
+
+#include <cstdio>
+#include <deque>
+#include <vector>
+
+#include "runtime/wave_rt.h"
+#include "sampler.h"
+#include "task.h"
+
+namespace wave {
+
+namespace {
+
+struct Frame {
+    const BcFunction* fn;
+    const Insn* pc;
+    uint32_t base;    // this frame's r0 within the register stack
+    TaskGroup* group; // spawned-task group, lazily created
+};
+
+// Prints go through the runtime's buffered output layer — the same
+// per-thread-buffer, single-writer path AOT-compiled code uses — so a
+// print costs a memcpy, not a lock or a syscall, on every tier.
+void write_str(std::string_view text) {
+    wave_rt_write_str(text.data(), text.size());
+}
+
+void write_int(int64_t value) {
+    wave_rt_write_int(value);
+}
+
+void write_f32(float value) {
+    wave_rt_write_f32(value);
+}
+
+void write_vec(const Value& value) {
+    wave_rt_write_vec(value.vec_v, vec_lanes(value.tag));
+}
+
+// One interpreter activation: runs functions[start_fn] with `argc`
+// argument values to completion. The main program and every spawned
+// task go through here, so tasks pay the same per-opcode cost as
+// straight-line code. `call_counts` is non-null only for the main
+// thread's --profile-generate run; task bodies are not counted.
+int exec(const BcProgram& program, uint16_t start_fn, const Value* args,
+         uint8_t argc, std::vector<uint64_t>* call_counts) {
+    const BcFunction* fn = &program.functions[start_fn];
+    std::vector<Value> regs(256);
+    std::vector<Frame> frames;
+    // Stable addresses for frame task groups: a spawned task keeps a
+    // pointer to its group until the frame's join drains it.
+    std::deque<TaskGroup> groups;
+    TaskGroup* group = nullptr;
+    uint32_t base = 0;
+    const Insn* pc = fn->code.data();
+    for (uint8_t i = 0; i < argc; i++)
+        regs[i] = args[i];
+    // Shadow-stack maintenance for the sampling profiler; one predicted
+    // branch per call/return when sampling is off.
+    Sampler& sampler = Sampler::global();
+    const bool sampling = sampler.enabled();
+    if (sampling)
+        sampler.attach(fn->name);
+
+// The interpreter's hot loop. With computed goto each opcode ends in its
+// own indirect jump, which lets the branch predictor learn per-opcode
+// successor patterns instead of fighting over one shared switch branch.
+#if defined(__GNUC__) || defined(__clang__)
+    static const void* dispatch_table[] = {
+        &&op_LoadK,    &&op_Move,     &&op_PrintLit, &&op_PrintInt,
+        &&op_PrintF32, &&op_PrintStr, &&op_PrintVec, &&op_VSet,
+        &&op_VAdd,     &&op_VMul,     &&op_Substr,   &&op_Call,
+        &&op_Spawn,    &&op_Join,     &&op_Ret,      &&op_Frame,
+    };
+#define DISPATCH()                                                            \
+    do {                                                                      \
+        insn = pc++;                                                          \
+        goto* dispatch_table[(int)insn->op];                                  \
+    } while (0)
+#define CASE(name) op_##name
+#else
+#define DISPATCH() goto dispatch_loop
+#define CASE(name) case Op::name
+#endif
+
+    const Insn* insn;
+#if !(defined(__GNUC__) || defined(__clang__))
+dispatch_loop:
+    insn = pc++;
+    switch (insn->op) {
+#endif
+
+    DISPATCH();
+
+CASE(LoadK):
+    regs[base + insn->a] = fn->constants[insn->c];
+    DISPATCH();
+
+CASE(Move):
+    regs[base + insn->a] = regs[base + insn->c];
+    DISPATCH();
+
+CASE(PrintLit): {
+    const Value& lit = fn->constants[insn->c];
+    write_str({lit.str_data, lit.str_len});
+    DISPATCH();
+}
+
+CASE(PrintInt):
+    write_int(regs[base + insn->a].int_v);
+    DISPATCH();
+
+CASE(PrintF32):
+    write_f32(regs[base + insn->a].f32_v);
+    DISPATCH();
+
+CASE(PrintStr): {
+    const Value& str = regs[base + insn->a];
+    write_str({str.str_data, str.str_len});
+    DISPATCH();
+}
+
+CASE(PrintVec):
+    write_vec(regs[base + insn->a]);
+    DISPATCH();
+
+CASE(VSet): {
+    const Value& src = regs[base + (insn->c & 0xff)];
+    regs[base + insn->a].vec_v[insn->c >> 8] =
+        src.tag == Type::Int ? (float)src.int_v : src.f32_v;
+    DISPATCH();
+}
+
+// All four lanes are processed unconditionally: the aligned arrays let
+// the compiler fold each loop into one packed SSE/NEON instruction, and
+// unused lanes are zero by construction.
+CASE(VAdd): {
+    Value& dst = regs[base + insn->a];
+    const Value& src = regs[base + insn->c];
+    for (int l = 0; l < 4; l++)
+        dst.vec_v[l] += src.vec_v[l];
+    DISPATCH();
+}
+
+CASE(VMul): {
+    Value& dst = regs[base + insn->a];
+    const Value& src = regs[base + insn->c];
+    for (int l = 0; l < 4; l++)
+        dst.vec_v[l] *= src.vec_v[l];
+    DISPATCH();
+}
+
+// An O(1) view: no bytes move, the result borrows the source's backing
+// data. Out-of-range requests clamp so a view never leaves it.
+CASE(Substr): {
+    const Value& src = regs[base + insn->c];
+    int64_t start = regs[base + insn->c + 1].int_v;
+    int64_t len = regs[base + insn->c + 2].int_v;
+    if (start < 0 || start > src.str_len)
+        start = start < 0 ? 0 : src.str_len;
+    if (len < 0 || len > src.str_len - start)
+        len = len < 0 ? 0 : src.str_len - start;
+    regs[base + insn->a] =
+        Value::make_str(src.str_data + start, (uint32_t)len);
+    DISPATCH();
+}
+
+CASE(Call): {
+    if (call_counts)
+        (*call_counts)[insn->c]++;
+    frames.push_back(Frame{fn, pc, base, group});
+    group = nullptr;
+    base += insn->a; // args already sit at the callee's r0..
+    fn = &program.functions[insn->c];
+    if (sampling)
+        sampler.push(fn->name);
+    if (base + fn->num_regs > regs.size())
+        regs.resize(regs.size() * 2 + fn->num_regs);
+    pc = fn->code.data();
+    DISPATCH();
+}
+
+CASE(Spawn): {
+    const BcFunction& callee = program.functions[insn->c];
+    // Drain our buffer first: output written before the spawn stays
+    // ahead of anything the task prints.
+    wave_rt_flush();
+    if (!group) {
+        groups.emplace_back();
+        group = &groups.back();
+    }
+    Task task;
+    task.program = &program;
+    task.fn = insn->c;
+    task.argc = callee.num_params;
+    task.group = group;
+    for (uint8_t i = 0; i < callee.num_params; i++)
+        task.args[i] = regs[base + insn->a + i];
+    group->pending.fetch_add(1, std::memory_order_acq_rel);
+    TaskScheduler::global().spawn(task);
+    DISPATCH();
+}
+
+// Structured join at function exit: this thread runs and steals tasks
+// until everything the frame spawned has finished.
+CASE(Join): {
+    if (group)
+        TaskScheduler::global().help_until(*group);
+    DISPATCH();
+}
+
+CASE(Ret): {
+    if (sampling)
+        sampler.pop();
+    if (frames.empty()) {
+        if (sampling)
+            sampler.detach();
+        return 0;
+    }
+    Frame frame = frames.back();
+    frames.pop_back();
+    fn = frame.fn;
+    pc = frame.pc;
+    base = frame.base;
+    group = frame.group;
+    DISPATCH();
+}
+
+CASE(Frame): {
+    if (sampling)
+        sampler.frame_mark();
+    DISPATCH();
+}
+
+#if !(defined(__GNUC__) || defined(__clang__))
+    }
+#endif
+#undef DISPATCH
+#undef CASE
+}
+
+} // namespace
+
+void execute_task(const Task& task) {
+    exec(*task.program, task.fn, task.args, task.argc, nullptr);
+    // Drain this worker's output before signalling completion so the
+    // spawner's join never races the task's bytes.
+    wave_rt_flush();
+    TaskScheduler::global().complete(*task.group);
+}
+
+int run_program(const BcProgram& program, ProfileData* profile) {
+    std::vector<uint64_t> call_counts(profile ? program.functions.size() : 0);
+    if (profile)
+        call_counts[program.main_index] = 1;
+
+    int rc = exec(program, program.main_index, nullptr, 0,
+                  profile ? &call_counts : nullptr);
+    wave_rt_flush();
+    if (profile)
+        for (size_t i = 0; i < call_counts.size(); i++)
+            profile->record(program.functions[i].name, call_counts[i]);
+    return rc;
+}
+
+} // namespace wave
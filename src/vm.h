@@ -0,0 +1,18 @@
+#pragma once
+
+#include "bytecode.h"
+#include "profile.h"
+
+namespace wave {
+
+// Executes a lowered program starting at 'main'. The dispatch loop uses
+// computed goto on compilers that support it (a switch elsewhere) and a
+// contiguous register stack; callee frames overlap the caller's argument
+// window so calls copy nothing. Returns the process exit code.
+//
+// With `profile` set, per-function call counts are accumulated into it
+// (one array increment per call; the dispatch loop is otherwise
+// untouched).
+int run_program(const BcProgram& program, ProfileData* profile = nullptr);
+
+} // namespace wave